@@ -0,0 +1,261 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../property.h"
+#include "../property_array.h"
+
+using namespace std;
+
+namespace
+{
+    struct Striped : PropertyPolicy<int>
+    {
+        using Lock = StripedLock;
+    };
+
+    struct Snapshot : PropertyPolicy<string>
+    {
+        using Storage = SnapshotStorage<string>;
+    };
+
+    struct Unit : PropertyPolicy<float>
+    {
+        using StaticCoercer = Clamp<-1, 1>;
+    };
+
+    /**
+     * @brief Assignment with `state.range(0)` change callbacks.
+     */
+    void BM_SetWithCallbacks(benchmark::State& state)
+    {
+        Property<int> property(0);
+        int sink = 0;
+        for (int64_t i = 0; i < state.range(0); ++i)
+            property.AddChangeCallback([&sink](int&, int& newValue) { sink += newValue; });
+        int value = 0;
+        for (auto _ : state)
+            property = ++value;
+        benchmark::DoNotOptimize(sink);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_SetWithCallbacks)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+    /**
+     * @brief Assignment of an unchanged value, i.e. the cost of change detection.
+     */
+    void BM_SetUnchanged(benchmark::State& state)
+    {
+        Property<int> property(1);
+        property.AddChangeCallback([](int&, int&) {});
+        for (auto _ : state)
+            property = 1;
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_SetUnchanged);
+
+    /**
+     * @brief Moving a large string into a property without listeners.
+     */
+    void BM_SetMovedString(benchmark::State& state)
+    {
+        Property<string> property;
+        vector<string> values(1024);
+        size_t round = 0;
+        while (state.KeepRunningBatch(values.size()))
+        {
+            state.PauseTiming(); // Once per batch, so the pause overhead is amortized.
+            ++round;
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i].assign(state.range(0), static_cast<char>('a' + (round + i) % 26));
+            state.ResumeTiming();
+            for (string& value : values)
+                property = std::move(value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_SetMovedString)->Arg(16)->Arg(4096);
+
+    /**
+     * @brief One source bound to `state.range(0)` targets.
+     */
+    void BM_BindingFanOut(benchmark::State& state)
+    {
+        Property<int> source(0);
+        vector<unique_ptr<Property<int>>> targets;
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            targets.push_back(make_unique<Property<int>>(0));
+            source.AddOneWayBind(*targets.back());
+        }
+        int value = 0;
+        for (auto _ : state)
+            source = ++value;
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_BindingFanOut)->Arg(1)->Arg(8)->Arg(64);
+
+    /**
+     * @brief A chain of `state.range(0)` bindings.
+     */
+    void BM_BindingChain(benchmark::State& state)
+    {
+        vector<unique_ptr<Property<int>>> chain;
+        chain.push_back(make_unique<Property<int>>(0));
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            chain.push_back(make_unique<Property<int>>(0));
+            chain[chain.size() - 2]->AddOneWayBind(*chain.back());
+        }
+        int value = 0;
+        for (auto _ : state)
+            *chain.front() = ++value;
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_BindingChain)->Arg(1)->Arg(16)->Arg(256);
+
+    /**
+     * @brief Registering and removing a callback by ID.
+     */
+    void BM_CallbackChurn(benchmark::State& state)
+    {
+        Property<int> property(0);
+        property.AddChangeCallback([](int&, int&) {}); // A permanent listener next to the churning one.
+        for (auto _ : state)
+        {
+            auto id = property.AddChangeCallback([](int&, int&) {});
+            property.RemoveChangeCallback(id);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_CallbackChurn);
+
+    /**
+     * @brief Registering and removing a callback through a `Subscription`.
+     */
+    void BM_SubscriptionChurn(benchmark::State& state)
+    {
+        Property<int> property(0);
+        for (auto _ : state)
+        {
+            Subscription subscription = property.Subscribe([](int&, int&) {});
+            benchmark::DoNotOptimize(subscription);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_SubscriptionChurn);
+
+    /**
+     * @brief One writer thread and `threads - 1` reader threads sharing a property.
+     */
+    template<typename P>
+    void BM_WriterReaders(benchmark::State& state)
+    {
+        static P* property = nullptr;
+        if (state.thread_index() == 0)
+            property = new P();
+        int value = 0;
+        for (auto _ : state)
+        {
+            if (state.thread_index() == 0)
+                *property = ++value;
+            else
+                benchmark::DoNotOptimize(property->Get());
+        }
+        state.SetItemsProcessed(state.iterations());
+        if (state.thread_index() == 0)
+        {
+            delete property;
+            property = nullptr;
+        }
+    }
+    BENCHMARK_TEMPLATE(BM_WriterReaders, Property<int>)->ThreadRange(1, 8)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_WriterReaders, Property<int, Striped>)->ThreadRange(1, 8)->UseRealTime();
+
+    /**
+     * @brief Every thread writing the same property.
+     */
+    void BM_ContendedWriters(benchmark::State& state)
+    {
+        static Property<int>* property = nullptr;
+        if (state.thread_index() == 0)
+            property = new Property<int>(0);
+        int value = state.thread_index() << 24;
+        for (auto _ : state)
+            *property = ++value;
+        state.SetItemsProcessed(state.iterations());
+        if (state.thread_index() == 0)
+        {
+            delete property;
+            property = nullptr;
+        }
+    }
+    BENCHMARK(BM_ContendedWriters)->ThreadRange(1, 8)->UseRealTime();
+
+    /**
+     * @brief Bulk clamped write into a `PropertyArray<float>`.
+     */
+    void BM_ArrayBulkSet(benchmark::State& state)
+    {
+        PropertyArray<float, Unit> array(state.range(0));
+        vector<float> values(state.range(0));
+        float offset = 0;
+        for (auto _ : state)
+        {
+            offset += 0.25f;
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i] = static_cast<float>(i % 7) * 0.5f - offset;
+            array.Set(0, values.data(), values.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ArrayBulkSet)->Arg(1024)->Arg(65536);
+
+    /**
+     * @brief Record the size of common instantiations in the benchmark context.
+     */
+    template<typename P>
+    void AddSize(const char* name)
+    {
+        benchmark::AddCustomContext(string("sizeof(") + name + ")", to_string(sizeof(P)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    AddSize<Property<bool>>("Property<bool>");
+    AddSize<Property<int>>("Property<int>");
+    AddSize<Property<int, Striped>>("Property<int, Striped>");
+    AddSize<Property<string>>("Property<string>");
+    AddSize<Property<string, Snapshot>>("Property<string, Snapshot>");
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "property.h"
+
+using namespace std;
+
+namespace PropertyInternals
+{
+    /**
+     * @brief State of a computed property shared with the callbacks on its inputs, so they never outlive it.
+     */
+    struct ComputedState
+    {
+        atomic<bool> dirty{ true }; /// Whether the cached value is out of date.
+        mutex dependentsMutex; /// Mutex for thread-safe access to the dependents.
+        vector<weak_ptr<ComputedState>> dependents; /// Computed properties using this one as an input.
+
+        /**
+         * @brief Register a computed property using this one as an input.
+         * @param dependent The state of the computed property.
+         */
+        void AddDependent(const shared_ptr<ComputedState>& dependent)
+        {
+            lock_guard<mutex> lock(dependentsMutex); // Ensure thread-safety.
+            PruneDependents();
+            dependents.push_back(dependent);
+        }
+
+        /**
+         * @brief Forget dependents that were destroyed. Must be called with `dependentsMutex` held.
+         */
+        void PruneDependents()
+        {
+            dependents.erase(remove_if(dependents.begin(), dependents.end(),
+                [](const weak_ptr<ComputedState>& dependent) { return dependent.expired(); }), dependents.end());
+        }
+
+        /**
+         * @brief Mark a state dirty, and its dependents if they were clean.
+         * @param state The state to invalidate.
+         */
+        static void Invalidate(ComputedState& state)
+        {
+            state.dirty.store(true, memory_order_release);
+            vector<weak_ptr<ComputedState>> dependents;
+            {
+                lock_guard<mutex> lock(state.dependentsMutex); // Ensure thread-safety.
+                state.PruneDependents();
+                dependents = state.dependents;
+            }
+            for (const weak_ptr<ComputedState>& dependent : dependents)
+                if (shared_ptr<ComputedState> alive = dependent.lock())
+                    if (!alive->dirty.exchange(true, memory_order_acq_rel))
+                        Invalidate(*alive); // Only clean dependents have clean dependents.
+        }
+    };
+}
+
+/**
+ * @brief Read-only value derived from other properties and recomputed lazily.
+ *
+ * The inputs are declared up front. A change of any input only marks the
+ * computed property dirty; the compute function runs on the next read, so a
+ * derivation nobody reads is never computed. Inputs may be `Property` instances
+ * of any value type or other `ComputedProperty` instances.
+ *
+ * Inputs must outlive the computed property, or be declared while it is alive
+ * only. Invalidations arriving after it is destroyed (for example through a
+ * dispatcher) are harmless.
+ */
+template<typename T>
+struct ComputedProperty
+{
+public:
+    /**
+     * @brief Type definition for the compute function.
+     *
+     * The function signature should be:
+     * T compute();
+     *
+     * @return The derived value.
+     */
+    using Compute = function<T()>;
+
+private:
+    using State = PropertyInternals::ComputedState;
+
+    Compute m_compute; /// Computes the value from the inputs.
+    mutable T m_value = T(); /// The cached value.
+    shared_ptr<State> m_state = make_shared<State>(); /// Dirty flag and dependents.
+    vector<function<void()>> m_refreshInputs; /// Brings computed inputs up to date before computing.
+    vector<function<void()>> m_detachInputs; /// Removes the callbacks registered on the inputs.
+    mutable mutex m_mutex; /// Mutex for thread-safe access.
+
+public:
+    /**
+     * @brief Constructor with compute function and inputs.
+     * @param compute The function computing the value.
+     * @param inputs The properties the value is derived from.
+     */
+    template<typename... Inputs>
+    explicit ComputedProperty(Compute compute, Inputs&... inputs) : m_compute(std::move(compute))
+    {
+        (AddInput(inputs), ...);
+    }
+
+    ComputedProperty(const ComputedProperty&) = delete;
+    ComputedProperty& operator=(const ComputedProperty&) = delete;
+
+    ~ComputedProperty()
+    {
+        for (const auto& detach : m_detachInputs)
+            detach(); // Unregister from every input.
+    }
+
+    /**
+     * @brief Declare a property as an input.
+     * @param input The property the value is derived from.
+     */
+    template<typename Input>
+    void AddInput(Input& input)
+    {
+        weak_ptr<State> state = m_state;
+        auto id = input.AddChangeCallback([state](auto&, auto&)
+        {
+            if (shared_ptr<State> alive = state.lock())
+                State::Invalidate(*alive);
+        });
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        m_detachInputs.push_back([&input, id] { input.RemoveChangeCallback(id); });
+        State::Invalidate(*m_state);
+    }
+
+    /**
+     * @brief Declare another computed property as an input.
+     * @param input The computed property the value is derived from.
+     */
+    template<typename U>
+    void AddInput(ComputedProperty<U>& input)
+    {
+        input.m_state->AddDependent(m_state);
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        m_refreshInputs.push_back([&input] { input.Get(); });
+        State::Invalidate(*m_state);
+    }
+
+    /**
+     * @brief Get the value, recomputing it first if an input changed.
+     * @return The current value.
+     */
+    T Get() const
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        if (m_state->dirty.exchange(false, memory_order_acq_rel))
+        {
+            for (const auto& refresh : m_refreshInputs)
+                refresh(); // Keep computed inputs clean while this one is clean.
+            m_value = m_compute();
+        }
+        return m_value;
+    }
+
+    /**
+     * @brief Conversion operator to get the value.
+     * @return The current value.
+     */
+    operator T() const
+    {
+        return Get();
+    }
+
+    /**
+     * @brief Check whether the next read will recompute the value.
+     * @return true if an input changed since the last computation.
+     */
+    bool IsDirty() const
+    {
+        return m_state->dirty.load(memory_order_acquire);
+    }
+
+    /**
+     * @brief Force the next read to recompute the value.
+     */
+    void Invalidate()
+    {
+        State::Invalidate(*m_state);
+    }
+
+private:
+    template<typename U>
+    friend struct ComputedProperty;
+};
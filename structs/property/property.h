@@ -26,313 +26,3234 @@
 #include <iostream>
 #include <functional>
 #include <unordered_map>
-#include <unordered_set>
 #include <algorithm>
 #include <mutex>
-#include <queue>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+#include <typeinfo>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <optional>
+#include "property_dispatcher.h"
+#include "property_simd.h"
+#include "property_instrumentation.h"
+#include "property_coroutine.h"
 
 using namespace std;
 
+/**
+ * @brief Storage policy that keeps the value as a plain member.
+ *
+ * Works for any copyable type. Reads are not lock-free: the property takes its
+ * lock around every read so readers never observe a half-written value.
+ */
 template<typename T>
-struct Property
+struct LockedStorage
+{
+    /// Whether `Load` may be called without holding the property lock.
+    static constexpr bool LockFreeReads = false;
+    /// Whether `Current` gives writers a reference to the stored value.
+    static constexpr bool InPlaceAccess = true;
+
+    LockedStorage(T value = T()) : m_value(std::move(value)) {}
+
+    /**
+     * @brief Read the current value.
+     * @return A copy of the current value.
+     */
+    T Load() const
+    {
+        return m_value;
+    }
+
+    /**
+     * @brief Inspect the current value without copying it (writer side only).
+     * @param visitor A function taking `const T&`.
+     * @return Whatever the visitor returns.
+     */
+    template<typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const
+    {
+        return visitor(m_value);
+    }
+
+    /**
+     * @brief Get the stored value itself (writer side only).
+     * @return A reference valid while the property lock is held.
+     */
+    T& Current()
+    {
+        return m_value;
+    }
+
+    /**
+     * @brief Replace the current value (writer side only).
+     * @param value The new value.
+     */
+    void Store(T&& value)
+    {
+        m_value = std::move(value);
+    }
+
+    /**
+     * @brief Replace the current value and return the previous one (writer side only).
+     * @param value The new value.
+     * @return The previous value, moved out of the storage.
+     */
+    T Exchange(T&& value)
+    {
+        return exchange(m_value, std::move(value));
+    }
+
+private:
+    T m_value; /// The stored value.
+};
+
+/**
+ * @brief Storage policy backed by `std::atomic<T>`.
+ *
+ * Meant for small trivially copyable types whose atomic is lock-free. Readers
+ * do a single acquire load.
+ */
+template<typename T>
+struct AtomicStorage
+{
+    static_assert(is_trivially_copyable<T>::value, "AtomicStorage requires a trivially copyable type.");
+
+    /// Whether `Load` may be called without holding the property lock.
+    static constexpr bool LockFreeReads = true;
+    /// Whether `Current` gives writers a reference to the stored value.
+    static constexpr bool InPlaceAccess = false;
+
+    AtomicStorage(T value = T()) : m_value(value) {}
+
+    /**
+     * @brief Read the current value.
+     * @return A copy of the current value.
+     */
+    T Load() const
+    {
+        return m_value.load(memory_order_acquire);
+    }
+
+    /**
+     * @brief Inspect the current value (writer side only).
+     * @param visitor A function taking `const T&`.
+     * @return Whatever the visitor returns.
+     */
+    template<typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const
+    {
+        const T value = m_value.load(memory_order_relaxed);
+        return visitor(value);
+    }
+
+    /**
+     * @brief Replace the current value (writer side only).
+     * @param value The new value.
+     */
+    void Store(T&& value)
+    {
+        m_value.store(value, memory_order_release);
+    }
+
+    /**
+     * @brief Replace the current value and return the previous one (writer side only).
+     * @param value The new value.
+     * @return The previous value.
+     */
+    T Exchange(T&& value)
+    {
+        return m_value.exchange(value, memory_order_acq_rel);
+    }
+
+private:
+    atomic<T> m_value; /// The stored value.
+};
+
+/**
+ * @brief Storage policy implementing a sequence lock.
+ *
+ * Meant for trivially copyable types too large for a lock-free atomic. The
+ * value is kept in atomic words; readers retry while a write is in progress
+ * so they never see a torn value, and never block the writer.
+ */
+template<typename T>
+struct SeqLockStorage
+{
+    static_assert(is_trivially_copyable<T>::value, "SeqLockStorage requires a trivially copyable type.");
+    static_assert(is_default_constructible<T>::value, "SeqLockStorage requires a default constructible type.");
+
+    /// Whether `Load` may be called without holding the property lock.
+    static constexpr bool LockFreeReads = true;
+    /// Whether `Current` gives writers a reference to the stored value.
+    static constexpr bool InPlaceAccess = false;
+
+    SeqLockStorage(T value = T())
+    {
+        Write(value);
+        m_sequence.store(0, memory_order_release);
+    }
+
+    /**
+     * @brief Read the current value, retrying while a write is in progress.
+     * @return A copy of the current value.
+     */
+    T Load() const
+    {
+        for (;;)
+        {
+            const size_t before = m_sequence.load(memory_order_acquire);
+            if (before & 1)
+                continue; // A write is in progress.
+            T value = Read();
+            atomic_thread_fence(memory_order_acquire);
+            if (m_sequence.load(memory_order_relaxed) == before)
+                return value;
+        }
+    }
+
+    /**
+     * @brief Inspect the current value (writer side only).
+     * @param visitor A function taking `const T&`.
+     * @return Whatever the visitor returns.
+     */
+    template<typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const
+    {
+        const T value = Read(); // No other writer can run, so no retry is needed.
+        return visitor(value);
+    }
+
+    /**
+     * @brief Replace the current value (writer side only).
+     * @param value The new value.
+     */
+    void Store(T&& value)
+    {
+        const size_t sequence = m_sequence.load(memory_order_relaxed);
+        m_sequence.store(sequence + 1, memory_order_relaxed); // Mark the write as in progress.
+        atomic_thread_fence(memory_order_release);
+        Write(value);
+        m_sequence.store(sequence + 2, memory_order_release); // Publish the new value.
+    }
+
+    /**
+     * @brief Replace the current value and return the previous one (writer side only).
+     * @param value The new value.
+     * @return The previous value.
+     */
+    T Exchange(T&& value)
+    {
+        T oldValue = Read();
+        Store(std::move(value));
+        return oldValue;
+    }
+
+private:
+    static constexpr size_t WordCount = (sizeof(T) + sizeof(size_t) - 1) / sizeof(size_t);
+
+    T Read() const
+    {
+        size_t words[WordCount];
+        for (size_t i = 0; i < WordCount; ++i)
+            words[i] = m_words[i].load(memory_order_relaxed);
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    void Write(const T& value)
+    {
+        size_t words[WordCount] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WordCount; ++i)
+            m_words[i].store(words[i], memory_order_relaxed);
+    }
+
+    atomic<size_t> m_sequence{ 0 }; /// Odd while a write is in progress.
+    atomic<size_t> m_words[WordCount]; /// The stored value, split into words.
+};
+
+/**
+ * @brief Storage policy publishing immutable snapshots (RCU style).
+ *
+ * Works for any copyable type. Every write publishes a new `shared_ptr<const T>`;
+ * readers grab the current snapshot without the property lock and keep it alive
+ * for as long as they hold it, so large values can be read without any copy
+ * through `Snapshot()`.
+ */
+template<typename T>
+struct SnapshotStorage
+{
+    /// Whether `Load` may be called without holding the property lock.
+    static constexpr bool LockFreeReads = true;
+    /// Whether `Current` gives writers a reference to the stored value.
+    static constexpr bool InPlaceAccess = false;
+
+    SnapshotStorage(T value = T()) : m_snapshot(make_shared<const T>(std::move(value))) {}
+
+    /**
+     * @brief Read the current value.
+     * @return A copy of the current value.
+     */
+    T Load() const
+    {
+        return *Snapshot();
+    }
+
+    /**
+     * @brief Grab the current snapshot without copying the value.
+     * @return A shared pointer to the current immutable value.
+     */
+    shared_ptr<const T> Snapshot() const
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return m_snapshot.load(memory_order_acquire);
+#else
+        return atomic_load_explicit(&m_snapshot, memory_order_acquire);
+#endif
+    }
+
+    /**
+     * @brief Inspect the current value without copying it (writer side only).
+     * @param visitor A function taking `const T&`.
+     * @return Whatever the visitor returns.
+     */
+    template<typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const
+    {
+        const shared_ptr<const T> snapshot = Snapshot();
+        return visitor(*snapshot);
+    }
+
+    /**
+     * @brief Publish a new value (writer side only).
+     * @param value The new value.
+     */
+    void Store(T&& value)
+    {
+        Publish(make_shared<const T>(std::move(value)));
+    }
+
+    /**
+     * @brief Publish a new value and return a copy of the previous one (writer side only).
+     *
+     * Readers may still hold the previous snapshot, so it is copied rather than moved.
+     *
+     * @param value The new value.
+     * @return A copy of the previous value.
+     */
+    T Exchange(T&& value)
+    {
+        T oldValue = *Snapshot();
+        Store(std::move(value));
+        return oldValue;
+    }
+
+private:
+    void Publish(shared_ptr<const T> snapshot)
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        m_snapshot.store(std::move(snapshot), memory_order_release);
+#else
+        atomic_store_explicit(&m_snapshot, std::move(snapshot), memory_order_release);
+#endif
+    }
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+    atomic<shared_ptr<const T>> m_snapshot; /// The current snapshot.
+#else
+    shared_ptr<const T> m_snapshot; /// The current snapshot, accessed atomically.
+#endif
+};
+
+namespace PropertyInternals
+{
+    template<typename T, bool = is_trivially_copyable<T>::value>
+    struct HasLockFreeAtomic : false_type {};
+
+    template<typename T>
+    struct HasLockFreeAtomic<T, true> : integral_constant<bool, atomic<T>::is_always_lock_free> {};
+
+    template<typename T>
+    struct DefaultStorage
+    {
+        using Type = conditional_t<HasLockFreeAtomic<T>::value, AtomicStorage<T>,
+            conditional_t<is_trivially_copyable<T>::value && is_default_constructible<T>::value,
+                SeqLockStorage<T>, LockedStorage<T>>>;
+    };
+}
+
+/**
+ * @brief Default storage policy for `T`.
+ *
+ * `AtomicStorage` for small trivially copyable types, `SeqLockStorage` for larger
+ * trivially copyable types and `LockedStorage` for everything else.
+ */
+template<typename T>
+using DefaultStorage = typename PropertyInternals::DefaultStorage<T>::Type;
+
+/**
+ * @brief Callable wrapper with fixed-size inline storage.
+ *
+ * A drop-in replacement for `std::function` that never allocates: the callable
+ * is stored inside the wrapper, and a callable larger than `Capacity` bytes is
+ * rejected at compile time. Invoking it costs one indirect call.
+ */
+template<typename Signature, size_t Capacity = 4 * sizeof(void*)>
+class InplaceFunction;
+
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
 {
 public:
+    InplaceFunction() noexcept = default;
+
+    InplaceFunction(nullptr_t) noexcept {}
+
+    /**
+     * @brief Construct from any callable that fits in the inline storage.
+     * @param callable The callable to store.
+     */
+    template<typename Callable, typename Stored = decay_t<Callable>,
+        typename = enable_if_t<!is_same<Stored, InplaceFunction>::value && is_invocable_r<R, Stored&, Args...>::value>>
+    InplaceFunction(Callable&& callable)
+    {
+        static_assert(sizeof(Stored) <= Capacity, "Callable does not fit in the inline storage of InplaceFunction.");
+        static_assert(alignof(Stored) <= alignof(max_align_t), "Callable is over-aligned for InplaceFunction.");
+        if constexpr (is_pointer<Stored>::value || is_member_pointer<Stored>::value)
+            if (callable == nullptr)
+                return; // A null function pointer makes an empty wrapper.
+        ::new (static_cast<void*>(m_storage)) Stored(std::forward<Callable>(callable));
+        m_operations = &OperationsFor<Stored>::Table;
+    }
+
+    InplaceFunction(const InplaceFunction& other)
+    {
+        if (other.m_operations)
+        {
+            other.m_operations->copy(m_storage, other.m_storage);
+            m_operations = other.m_operations;
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept
+    {
+        if (other.m_operations)
+        {
+            other.m_operations->move(m_storage, other.m_storage);
+            m_operations = other.m_operations;
+            other.Reset();
+        }
+    }
+
+    ~InplaceFunction()
+    {
+        Reset();
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& other)
+    {
+        if (this != &other)
+        {
+            Reset();
+            new (this) InplaceFunction(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            new (this) InplaceFunction(std::move(other));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Check whether a callable is stored.
+     */
+    explicit operator bool() const noexcept
+    {
+        return m_operations != nullptr;
+    }
+
+    /**
+     * @brief Invoke the stored callable.
+     */
+    R operator()(Args... args) const
+    {
+        if (!m_operations)
+            throw bad_function_call();
+        return m_operations->invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Get the type of the stored callable, like `std::function::target_type`.
+     */
+    const type_info& target_type() const noexcept
+    {
+        return m_operations ? m_operations->type() : typeid(void);
+    }
+
+    /**
+     * @brief Get a pointer to the stored callable, like `std::function::target`.
+     * @return The stored callable, or nullptr if it is not of type `Callable`.
+     */
+    template<typename Callable>
+    Callable* target() noexcept
+    {
+        return target_type() == typeid(Callable) ? reinterpret_cast<Callable*>(m_storage) : nullptr;
+    }
+
+    template<typename Callable>
+    const Callable* target() const noexcept
+    {
+        return target_type() == typeid(Callable) ? reinterpret_cast<const Callable*>(m_storage) : nullptr;
+    }
+
+private:
+    struct Operations
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*copy)(void* destination, const void* source);
+        void (*move)(void* destination, void* source);
+        void (*destroy)(void* storage);
+        const type_info& (*type)();
+    };
+
+    template<typename Stored>
+    struct OperationsFor
+    {
+        static R Invoke(void* storage, Args&&... args)
+        {
+            if constexpr (is_void<R>::value)
+                invoke(*static_cast<Stored*>(storage), std::forward<Args>(args)...);
+            else
+                return invoke(*static_cast<Stored*>(storage), std::forward<Args>(args)...);
+        }
+
+        static void Copy(void* destination, const void* source)
+        {
+            ::new (destination) Stored(*static_cast<const Stored*>(source));
+        }
+
+        static void Move(void* destination, void* source)
+        {
+            ::new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+        }
+
+        static void Destroy(void* storage)
+        {
+            static_cast<Stored*>(storage)->~Stored();
+        }
+
+        static const type_info& Type()
+        {
+            return typeid(Stored);
+        }
+
+        static constexpr Operations Table = { &Invoke, &Copy, &Move, &Destroy, &Type };
+    };
+
+    void Reset() noexcept
+    {
+        if (m_operations)
+        {
+            m_operations->destroy(m_storage);
+            m_operations = nullptr;
+        }
+    }
+
+    alignas(max_align_t) unsigned char m_storage[Capacity]; /// Inline storage for the callable.
+    const Operations* m_operations = nullptr; /// Operations of the stored callable, null when empty.
+};
+
+/**
+ * @brief Flat registry of callbacks addressed by generation-tagged IDs.
+ *
+ * The first `InlineCapacity` slots live inside the registry itself and further
+ * slots spill into a vector, so iterating is a linear scan over contiguous
+ * memory. A removed slot is recycled through an intrusive free list and its
+ * generation is bumped, so an ID that was already removed never matches the
+ * callback that later reuses its slot.
+ */
+template<typename Callback, size_t InlineCapacity = 3, typename Allocator = allocator<Callback>>
+struct CallbackRegistry
+{
+    /**
+     * @brief Type definition for callback IDs.
+     *
+     * The low half of the bits holds the slot index, the high half its generation.
+     */
+    using ID = size_t;
+
+    CallbackRegistry() = default;
+
+    /**
+     * @brief Constructor.
+     * @param allocator Allocator for the slots beyond the inline capacity.
+     */
+    explicit CallbackRegistry(const Allocator& allocator) : m_overflow(SlotAllocator(allocator)) {}
+
+    CallbackRegistry(const CallbackRegistry&) = delete;
+    CallbackRegistry& operator=(const CallbackRegistry&) = delete;
+
+    /**
+     * @brief Add a callback.
+     * @param callback The callback to add.
+     * @return The ID of the added callback.
+     */
+    ID Add(Callback callback)
+    {
+        size_t index;
+        if (m_freeHead != NoSlot)
+        {
+            index = m_freeHead; // Reuse a free slot.
+            m_freeHead = SlotAt(index).nextFree;
+        }
+        else
+        {
+            index = m_slotCount++; // Take a new slot.
+            if (index >= InlineCapacity)
+                m_overflow.emplace_back();
+        }
+        Slot& slot = SlotAt(index);
+        slot.callback = std::move(callback);
+        slot.used = true;
+        ++m_size;
+        return MakeID(index, slot.generation);
+    }
+
+    /**
+     * @brief Remove a callback using its ID.
+     * @param id The ID of the callback to remove.
+     * @return true if the callback was found and removed.
+     */
+    bool Remove(ID id)
+    {
+        const size_t index = id & IndexMask;
+        if (index >= m_slotCount)
+            return false;
+        Slot& slot = SlotAt(index);
+        if (!slot.used || slot.generation != (id >> IndexBits))
+            return false; // Already removed, the slot may have been reused.
+        Release(index);
+        return true;
+    }
+
+    /**
+     * @brief Remove the first callback matching a predicate.
+     * @param predicate A function taking `const Callback&`.
+     * @return true if a callback was found and removed.
+     */
+    template<typename Predicate>
+    bool RemoveFirst(Predicate&& predicate)
+    {
+        for (size_t index = 0; index < m_slotCount; ++index)
+        {
+            const Slot& slot = SlotAt(index);
+            if (slot.used && predicate(slot.callback))
+            {
+                Release(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Call a function for every registered callback, in slot order.
+     * @param function A function taking `const Callback&`.
+     */
+    template<typename Function>
+    void ForEach(Function&& function) const
+    {
+        const size_t inlineCount = m_slotCount < InlineCapacity ? m_slotCount : InlineCapacity;
+        for (size_t index = 0; index < inlineCount; ++index)
+            if (m_inline[index].used)
+                function(m_inline[index].callback);
+        for (const Slot& slot : m_overflow)
+            if (slot.used)
+                function(slot.callback);
+    }
+
+    /**
+     * @brief Call a function for every registered callback and its ID, in slot order.
+     * @param function A function taking `ID` and `const Callback&`.
+     */
+    template<typename Function>
+    void ForEachWithID(Function&& function) const
+    {
+        for (size_t index = 0; index < m_slotCount; ++index)
+        {
+            const Slot& slot = SlotAt(index);
+            if (slot.used)
+                function(MakeID(index, slot.generation), slot.callback);
+        }
+    }
+
+    /**
+     * @brief Get the number of registered callbacks.
+     */
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Check whether no callback is registered.
+     */
+    bool Empty() const
+    {
+        return m_size == 0;
+    }
+
+private:
+    static constexpr size_t IndexBits = sizeof(ID) * 4;
+    static constexpr ID IndexMask = (ID(1) << IndexBits) - 1;
+    static constexpr size_t NoSlot = IndexMask;
+
+    struct Slot
+    {
+        Callback callback; /// The stored callback, empty when the slot is free.
+        size_t generation = 0; /// Bumped every time the slot is released.
+        size_t nextFree = NoSlot; /// Next free slot while this one is free.
+        bool used = false; /// Whether the slot holds a live callback.
+    };
+
+    static ID MakeID(size_t index, size_t generation)
+    {
+        return (ID(generation & IndexMask) << IndexBits) | index;
+    }
+
+    Slot& SlotAt(size_t index)
+    {
+        return index < InlineCapacity ? m_inline[index] : m_overflow[index - InlineCapacity];
+    }
+
+    const Slot& SlotAt(size_t index) const
+    {
+        return index < InlineCapacity ? m_inline[index] : m_overflow[index - InlineCapacity];
+    }
+
+    void Release(size_t index)
+    {
+        Slot& slot = SlotAt(index);
+        slot.callback = Callback(); // Drop captured state right away.
+        slot.used = false;
+        slot.generation = (slot.generation + 1) & IndexMask;
+        slot.nextFree = m_freeHead;
+        m_freeHead = index;
+        --m_size;
+    }
+
+    using SlotAllocator = typename allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+    Slot m_inline[InlineCapacity]; /// Slots stored in place.
+    vector<Slot, SlotAllocator> m_overflow; /// Slots beyond the inline capacity.
+    size_t m_slotCount = 0; /// Number of slots ever taken.
+    size_t m_freeHead = NoSlot; /// Head of the free slot list.
+    size_t m_size = 0; /// Number of live callbacks.
+};
+
+/**
+ * @brief Move-only token keeping a change callback registered.
+ *
+ * Returned by `Property::Subscribe`. Destroying or resetting the token removes
+ * its callback by ID, in O(1). If the property is destroyed first the token
+ * becomes empty, so it is safe to hold it longer than the property.
+ */
+struct Subscription
+{
+    /**
+     * @brief Connection shared between a property and its tokens, cleared when the property is destroyed.
+     */
+    struct Link
+    {
+        mutex linkMutex; /// Held while removing a callback or clearing the owner.
+        void* owner = nullptr; /// The property, null once it is destroyed.
+        void (*remove)(void* owner, size_t id) = nullptr; /// Removes a callback of the owner by ID.
+    };
+
+    Subscription() = default;
+
+    /**
+     * @brief Constructor.
+     * @param link The link of the property the callback is registered with.
+     * @param id The ID of the callback.
+     */
+    Subscription(shared_ptr<Link> link, size_t id) : m_link(std::move(link)), m_id(id) {}
+
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+
+    Subscription(Subscription&& other) noexcept : m_link(std::move(other.m_link)), m_id(other.m_id) {}
+
+    Subscription& operator=(Subscription&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_link = std::move(other.m_link);
+            m_id = other.m_id;
+        }
+        return *this;
+    }
+
+    ~Subscription()
+    {
+        Reset();
+    }
+
+    /**
+     * @brief Remove the callback now, if the property still exists, and empty the token.
+     */
+    void Reset()
+    {
+        if (!m_link)
+            return;
+        shared_ptr<Link> link = std::move(m_link);
+        lock_guard<mutex> lock(link->linkMutex); // Keeps the property alive while removing.
+        if (link->owner)
+            link->remove(link->owner, m_id);
+    }
+
+    /**
+     * @brief Empty the token but keep the callback registered.
+     * @return The ID of the callback, for `RemoveChangeCallback`.
+     */
+    size_t Release()
+    {
+        m_link.reset();
+        return m_id;
+    }
+
+    /**
+     * @brief Check whether the token holds a callback of a property that still exists.
+     */
+    explicit operator bool() const
+    {
+        if (!m_link)
+            return false;
+        lock_guard<mutex> lock(m_link->linkMutex); // Ensure thread-safety.
+        return m_link->owner != nullptr;
+    }
+
+private:
+    shared_ptr<Link> m_link; /// The link of the property, null when empty.
+    size_t m_id = 0; /// The ID of the callback.
+};
+
+struct BindingAnchor;
+
+/**
+ * @brief Type-erased node of the binding graph.
+ *
+ * Every property is a node; its bindings are the outgoing edges. Keeping the
+ * graph type-erased lets `BindingGraph` propagate through properties of any
+ * value type. The node itself is empty: edges carry plain function pointers
+ * instead of a vtable, so properties pay nothing for being nodes.
+ */
+struct BindingNode
+{
+protected:
+    BindingNode() = default;
+    ~BindingNode() = default;
+
+    /**
+     * @brief Type definition for the function pushing a value along an edge.
+     *
+     * @param source The node the value comes from.
+     * @param target The node the value goes to.
+     * @param sourceValue The new value of `source` if the caller has it at hand, nullptr to read it.
+     * @param stamp The stamp of the write being propagated, see `BindingGraph::NextStamp`.
+     * @param context The context of the edge, e.g. a converter, or nullptr.
+     * @return true if the target changed.
+     */
+    using ApplyFunction = bool (*)(BindingNode& source, BindingNode& target, const void* sourceValue, uint64_t stamp, const void* context);
+
+    struct Edge;
+
+    /**
+     * @brief Type definition for the function appending the outgoing edges of a node, copied under its lock.
+     *
+     * @param node The node whose edges are copied.
+     * @param out The vector the edges are appended to.
+     */
+    using EdgesFunction = void (*)(const BindingNode& node, vector<Edge>& out);
+
+    /**
+     * @brief Directed binding from one node to another.
+     */
+    struct Edge
+    {
+        shared_ptr<BindingAnchor> target; /// The anchor of the node the value flows to.
+        ApplyFunction apply; /// Pushes the value of the source into the target.
+        EdgesFunction targetEdges; /// Appends the outgoing edges of the target.
+        shared_ptr<const void> context; /// State passed to `apply`, e.g. a converter; null for plain bindings.
+    };
+
+    friend struct BindingGraph;
+};
+
+/**
+ * @brief Weak handle to a binding node, shared by every edge leading to it.
+ *
+ * Edges never point at a node directly: `BindingGraph` pins the anchor of a
+ * node for as long as a propagation uses it, and a node retires its anchor
+ * when it is destroyed, waiting for the propagations still using it. Edges to
+ * a retired anchor are skipped and pruned by their source, so either end of a
+ * binding can be destroyed at any time without unbinding first and without a
+ * global lock.
+ */
+struct BindingAnchor
+{
+    /**
+     * @brief Constructor.
+     * @param node The node this anchor stands for.
+     */
+    explicit BindingAnchor(BindingNode* node) : m_node(node) {}
+
+    /**
+     * @brief Keep the node alive until `Unpin`.
+     * @return The node, or nullptr if it is being destroyed.
+     */
+    BindingNode* Pin()
+    {
+        m_pins.fetch_add(1, memory_order_seq_cst);
+        if (!m_alive.load(memory_order_seq_cst))
+        {
+            Unpin();
+            return nullptr;
+        }
+        return m_node;
+    }
+
+    /**
+     * @brief Release a successful `Pin`.
+     */
+    void Unpin()
+    {
+        m_pins.fetch_sub(1, memory_order_release);
+    }
+
+    /**
+     * @brief Mark the node as destroyed and wait until no propagation uses it.
+     *
+     * Called by the node's destructor. The node must not be destroyed from
+     * inside a propagation that reaches it.
+     */
+    void Retire()
+    {
+        m_alive.store(false, memory_order_seq_cst);
+        while (m_pins.load(memory_order_acquire) != 0)
+            this_thread::yield(); // A propagation is still pushing a value into the node.
+    }
+
+    /**
+     * @brief Check whether the node was destroyed.
+     */
+    bool Retired() const
+    {
+        return !m_alive.load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the node for identity comparisons. Must not be dereferenced unless pinned.
+     */
+    const BindingNode* Node() const
+    {
+        return m_node;
+    }
+
+private:
+    BindingNode* const m_node; /// The node.
+    atomic<size_t> m_pins{ 0 }; /// Propagations currently using the node.
+    atomic<bool> m_alive{ true }; /// Cleared when the node is destroyed.
+};
+
+/**
+ * @brief Propagates a change through the binding graph in topological order.
+ *
+ * A depth-first search from the changed node computes a reverse postorder of
+ * every node reachable through bindings. Edges leading back to a node still on
+ * the search stack close a cycle (for example the two halves of a two-way
+ * binding) and are skipped. Nodes are then updated in that order, each at most
+ * once, from its last updated predecessor, so diamonds and long chains cost
+ * O(nodes + edges) per change and cycles cannot loop.
+ *
+ * Propagation runs without holding the lock of the changed node, and each
+ * target is locked on its own while its value is pushed, so no thread ever
+ * holds two property locks and writers on both ends of a two-way binding
+ * cannot deadlock. Every write to a bound property takes a stamp from a global
+ * clock that travels with the change; a target only accepts a change newer than
+ * the one it holds, so concurrent writers converge on the last write instead of
+ * overwriting each other, and stale changes are dropped before the target's
+ * lock is taken.
+ */
+struct BindingGraph
+{
+    /**
+     * @brief Statistics of one propagation.
+     */
+    struct Result
+    {
+        size_t visited = 0; /// Nodes a value was pushed into.
+        size_t updated = 0; /// Nodes whose value changed.
+        size_t cycles = 0; /// Edges skipped because they close a cycle.
+    };
+
+    /**
+     * @brief Take a stamp for a write to a bound node.
+     * @return A stamp greater than every stamp taken before.
+     */
+    static uint64_t NextStamp()
+    {
+        return s_clock.fetch_add(1, memory_order_relaxed) + 1;
+    }
+
+    /**
+     * @brief One propagation of a change, using buffers reused by every propagation of the thread.
+     *
+     * The writer creates it while holding its lock, appends its outgoing edges
+     * to `Edges`, and calls `Run` after releasing the lock. Change callbacks
+     * may start nested propagations on the same thread; each takes the next
+     * set of buffers, so after warm-up a propagation does not allocate.
+     */
+    struct Propagation
+    {
+        Propagation() : m_scratch(Acquire()) {}
+
+        Propagation(const Propagation&) = delete;
+        Propagation& operator=(const Propagation&) = delete;
+
+        ~Propagation()
+        {
+            m_scratch.Clear();
+            --Depth();
+        }
+
+        /**
+         * @brief Get the buffer the outgoing edges of the changed node are appended to.
+         */
+        vector<BindingNode::Edge>& Edges()
+        {
+            return m_scratch.edges;
+        }
+
+        /**
+         * @brief Propagate a change of `root` to every node reachable through bindings.
+         *
+         * Must be called without holding the lock of `root`.
+         *
+         * @param root The node that changed; its outgoing edges are in `Edges`.
+         * @param rootValue The new value of `root`, passed to the edges leaving it.
+         * @param stamp The stamp of the write to `root`.
+         * @return Statistics of the propagation.
+         */
+        Result Run(BindingNode& root, const void* rootValue, uint64_t stamp)
+        {
+            Result result;
+            if (m_scratch.edges.empty() || RunSingleHop(root, rootValue, stamp, result))
+                return result;
+            RunGraph(root, rootValue, stamp, result);
+            return result;
+        }
+
+    private:
+        static constexpr size_t None = SIZE_MAX;
+
+        struct Visit
+        {
+            BindingNode* node; /// The node.
+            bool onStack; /// Still on the search stack.
+            bool changed; /// Updated during this propagation.
+            size_t order; /// Position in the topological order.
+            size_t firstIncoming; /// Head of the list of predecessors in `incoming`, or `None`.
+        };
+
+        struct Incoming
+        {
+            size_t source; /// The visit of the predecessor.
+            BindingNode::ApplyFunction apply; /// The edge from the predecessor.
+            const void* context; /// The context of that edge, kept alive by `edges`.
+            size_t next; /// The next predecessor of the same node, or `None`.
+        };
+
+        struct Frame
+        {
+            size_t visit; /// The node being searched.
+            size_t next; /// Index in `edges` of the next edge to follow.
+            size_t end; /// One past the last outgoing edge of the node in `edges`.
+        };
+
+        /**
+         * @brief Buffers of one propagation, cleared but never shrunk.
+         */
+        struct Scratch
+        {
+            vector<BindingNode::Edge> edges; /// Outgoing edges of every node reached, keeping their anchors and contexts alive.
+            vector<BindingAnchor*> pins; /// Anchors pinned by this propagation.
+            vector<Visit> visits; /// Nodes reached, in discovery order.
+            vector<Incoming> incoming; /// Edges in the search tree or joining it, excluding those closing a cycle.
+            vector<Frame> stack; /// The search stack.
+            vector<size_t> postorder; /// Visits in postorder.
+            vector<size_t> index; /// Open-addressed table of visit index + 1 by node, used once many nodes are reached.
+
+            void Clear()
+            {
+                for (BindingAnchor* anchor : pins)
+                    anchor->Unpin();
+                pins.clear();
+                edges.clear();
+                visits.clear();
+                incoming.clear();
+                stack.clear();
+                postorder.clear();
+                index.clear();
+            }
+        };
+
+        static Scratch& Acquire()
+        {
+            static thread_local vector<unique_ptr<Scratch>> pool; // One per nesting level.
+            size_t& depth = Depth();
+            if (depth == pool.size())
+                pool.push_back(make_unique<Scratch>());
+            return *pool[depth++];
+        }
+
+        static size_t& Depth()
+        {
+            static thread_local size_t depth = 0;
+            return depth;
+        }
+
+        /**
+         * @brief Push the change straight into the targets if none of them has bindings of its own.
+         * @return false if the graph has to be searched.
+         */
+        bool RunSingleHop(BindingNode& root, const void* rootValue, uint64_t stamp, Result& result)
+        {
+            vector<BindingNode::Edge>& edges = m_scratch.edges;
+            const size_t count = edges.size();
+            if (count > 8)
+                return false; // Checking for repeated targets would cost more than the search.
+            for (size_t i = 0; i < count; ++i)
+                for (size_t j = 0; j < i; ++j)
+                    if (edges[i].target == edges[j].target)
+                        return false; // The search updates a target once.
+            BindingNode* targets[8];
+            for (size_t i = 0; i < count; ++i)
+            {
+                targets[i] = edges[i].target->Pin();
+                if (!targets[i])
+                    continue; // The target is being destroyed.
+                m_scratch.pins.push_back(edges[i].target.get());
+                edges[i].targetEdges(*targets[i], edges);
+                if (edges.size() > count)
+                {
+                    edges.resize(count); // The target has bindings; search instead.
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!targets[i])
+                    continue;
+                ++result.visited;
+                if (edges[i].apply(root, *targets[i], rootValue, stamp, edges[i].context.get()))
+                    ++result.updated;
+            }
+            return true;
+        }
+
+        void RunGraph(BindingNode& root, const void* rootValue, uint64_t stamp, Result& result)
+        {
+            Scratch& s = m_scratch;
+            AddVisit(&root);
+            s.stack.push_back({ 0, 0, s.edges.size() });
+            while (!s.stack.empty())
+            {
+                Frame& frame = s.stack.back();
+                if (frame.next == frame.end)
+                {
+                    s.visits[frame.visit].onStack = false;
+                    s.postorder.push_back(frame.visit);
+                    s.stack.pop_back();
+                    continue;
+                }
+                const size_t source = frame.visit;
+                const size_t edgeIndex = frame.next++;
+                BindingAnchor* anchor = s.edges[edgeIndex].target.get();
+                BindingNode* target = anchor->Pin();
+                if (!target)
+                    continue; // The target is being destroyed.
+                s.pins.push_back(anchor);
+                const BindingNode::ApplyFunction apply = s.edges[edgeIndex].apply;
+                const void* context = s.edges[edgeIndex].context.get();
+                size_t visit = FindVisit(target);
+                if (visit == None)
+                {
+                    visit = AddVisit(target);
+                    AddIncoming(visit, source, apply, context);
+                    const size_t begin = s.edges.size();
+                    s.edges[edgeIndex].targetEdges(*target, s.edges); // Invalidates `frame` and edge references.
+                    s.stack.push_back({ visit, begin, s.edges.size() });
+                }
+                else if (s.visits[visit].onStack)
+                {
+                    ++result.cycles; // The edge closes a cycle.
+                }
+                else
+                {
+                    AddIncoming(visit, source, apply, context);
+                }
+            }
+
+            // Reverse postorder: every remaining edge goes from an earlier node to a later one.
+            const size_t count = s.postorder.size();
+            for (size_t i = 0; i < count; ++i)
+                s.visits[s.postorder[i]].order = count - 1 - i;
+            s.visits[0].changed = true;
+            for (size_t i = count - 1; i-- > 0;)
+            {
+                Visit& visit = s.visits[s.postorder[i]];
+                const Incoming* from = nullptr;
+                size_t fromOrder = 0;
+                for (size_t next = visit.firstIncoming; next != None; next = s.incoming[next].next)
+                {
+                    const Incoming& incoming = s.incoming[next];
+                    const Visit& source = s.visits[incoming.source];
+                    if (source.changed && (!from || source.order > fromOrder))
+                    {
+                        from = &incoming;
+                        fromOrder = source.order;
+                    }
+                }
+                if (!from)
+                    continue; // No predecessor changed.
+                ++result.visited;
+                BindingNode& source = *s.visits[from->source].node;
+                visit.changed = from->apply(source, *visit.node, from->source == 0 ? rootValue : nullptr, stamp, from->context);
+                if (visit.changed)
+                    ++result.updated;
+            }
+        }
+
+        void AddIncoming(size_t visit, size_t source, BindingNode::ApplyFunction apply, const void* context)
+        {
+            m_scratch.incoming.push_back({ source, apply, context, m_scratch.visits[visit].firstIncoming });
+            m_scratch.visits[visit].firstIncoming = m_scratch.incoming.size() - 1;
+        }
+
+        static size_t Slot(const BindingNode* node, size_t mask)
+        {
+            return static_cast<size_t>((reinterpret_cast<uintptr_t>(node) >> 4) * 0x9E3779B97F4A7C15ull) & mask;
+        }
+
+        size_t FindVisit(const BindingNode* node) const
+        {
+            const Scratch& s = m_scratch;
+            if (s.index.empty())
+            {
+                for (size_t i = 0; i < s.visits.size(); ++i)
+                    if (s.visits[i].node == node)
+                        return i;
+                return None;
+            }
+            const size_t mask = s.index.size() - 1;
+            for (size_t slot = Slot(node, mask); s.index[slot] != 0; slot = (slot + 1) & mask)
+                if (s.visits[s.index[slot] - 1].node == node)
+                    return s.index[slot] - 1;
+            return None;
+        }
+
+        size_t AddVisit(BindingNode* node)
+        {
+            Scratch& s = m_scratch;
+            s.visits.push_back({ node, true, false, 0, None });
+            const size_t visit = s.visits.size() - 1;
+            if (s.visits.size() <= 16)
+                return visit; // Small graphs are searched linearly.
+            if (s.index.size() < 2 * s.visits.size())
+            {
+                s.index.assign(max<size_t>(64, 2 * s.index.size()), 0); // Rebuild at a quarter load, keeping a power of two.
+                for (size_t i = 0; i < visit; ++i)
+                    Index(i);
+            }
+            Index(visit);
+            return visit;
+        }
+
+        void Index(size_t visit)
+        {
+            Scratch& s = m_scratch;
+            const size_t mask = s.index.size() - 1;
+            size_t slot = Slot(s.visits[visit].node, mask);
+            while (s.index[slot] != 0)
+                slot = (slot + 1) & mask;
+            s.index[slot] = visit + 1;
+        }
+
+        Scratch& m_scratch; /// The buffers of this propagation.
+    };
+
+private:
+    static inline atomic<uint64_t> s_clock{ 0 }; /// Source of write stamps.
+};
+
+/**
+ * @brief Static validator that accepts every value.
+ */
+struct AcceptAll
+{
+    template<typename T>
+    constexpr bool operator()(const T&) const
+    {
+        return true;
+    }
+
+    template<typename T>
+    constexpr size_t operator()(const T*, size_t count) const
+    {
+        return count;
+    }
+};
+
+/**
+ * @brief Static coercer that leaves every value untouched.
+ */
+struct NoCoercion
+{
+    template<typename T>
+    constexpr void operator()(T&) const {}
+
+    template<typename T>
+    constexpr void operator()(T*, size_t) const {}
+};
+
+/**
+ * @brief Static validator accepting values in the closed range [Min, Max].
+ *
+ * Arithmetic spans are checked with vector instructions (see `property_simd.h`).
+ */
+template<auto Min, auto Max>
+struct InRange
+{
+    template<typename T>
+    constexpr bool operator()(const T& value) const
+    {
+        return !(value < Min) && !(Max < value);
+    }
+
+    /**
+     * @brief Check a span of values.
+     * @return The index of the first rejected value, or `count` if all are accepted.
+     */
+    template<typename T, typename = enable_if_t<is_arithmetic_v<T>>>
+    size_t operator()(const T* values, size_t count) const
+    {
+        return PropertyInternals::FindOutOfRange(values, count, static_cast<T>(Min), static_cast<T>(Max));
+    }
+};
+
+/**
+ * @brief Static coercer clamping values into the closed range [Min, Max].
+ *
+ * Arithmetic spans are clamped with vector instructions (see `property_simd.h`).
+ */
+template<auto Min, auto Max>
+struct Clamp
+{
+    template<typename T>
+    constexpr void operator()(T& value) const
+    {
+        if (value < Min)
+            value = Min;
+        else if (Max < value)
+            value = Max;
+    }
+
+    /**
+     * @brief Clamp a span of values.
+     */
+    template<typename T, typename = enable_if_t<is_arithmetic_v<T>>>
+    void operator()(T* values, size_t count) const
+    {
+        PropertyInternals::ClampSpan(values, count, static_cast<T>(Min), static_cast<T>(Max));
+    }
+};
+
+/**
+ * @brief Static validator rejecting NaN and infinite values. Accepts every non floating-point value.
+ *
+ * Spans are checked with vector instructions (see `property_simd.h`).
+ */
+struct Finite
+{
+    template<typename T>
+    bool operator()(const T& value) const
+    {
+        if constexpr (is_floating_point_v<T>)
+            return isfinite(value);
+        else
+            return true;
+    }
+
+    /**
+     * @brief Check a span of values.
+     * @return The index of the first rejected value, or `count` if all are accepted.
+     */
+    template<typename T>
+    size_t operator()(const T* values, size_t count) const
+    {
+        return PropertyInternals::FindNotFinite(values, count);
+    }
+};
+
+/**
+ * @brief Comparator treating values as changed when `operator!=` says so. The default.
+ *
+ * For pointer-like values (`shared_ptr<const Big>`) this already is an O(1)
+ * identity comparison.
+ */
+struct NotEqual
+{
+    template<typename T>
+    constexpr bool operator()(const T& oldValue, const T& newValue) const
+    {
+        return oldValue != newValue;
+    }
+};
+
+/**
+ * @brief Comparator treating every write as a change.
+ *
+ * For values that are expensive or impossible to compare; every assignment notifies.
+ */
+struct AlwaysChanged
+{
+    template<typename T>
+    constexpr bool operator()(const T&, const T&) const
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief Comparator comparing a cheap key of the values instead of the values themselves.
+ *
+ * `Key` is a stateless function object returning, for example, a version stamp
+ * or a cached hash kept inside the value.
+ */
+template<typename Key>
+struct CompareBy
+{
+    template<typename T>
+    constexpr bool operator()(const T& oldValue, const T& newValue) const
+    {
+        return Key{}(oldValue) != Key{}(newValue);
+    }
+};
+
+namespace PropertyInternals
+{
+    /// Holds the runtime validator and coerce callback when the policy enables them.
+    template<typename Validator, typename CoerceCallback, bool Enabled>
+    struct DynamicValidation
+    {
+        DynamicValidation(Validator validator = Validator(), CoerceCallback coerceCallback = CoerceCallback())
+            : m_validator(std::move(validator)), m_coerceCallback(std::move(coerceCallback)) {}
+
+        Validator m_validator; /// Validator function for new values.
+        CoerceCallback m_coerceCallback; /// Coerce callback function for new values.
+    };
+
+    /// Empty when the policy disables runtime validation, so it takes no space as a base.
+    template<typename Validator, typename CoerceCallback>
+    struct DynamicValidation<Validator, CoerceCallback, false>
+    {
+        DynamicValidation(Validator = Validator(), CoerceCallback = CoerceCallback()) {}
+    };
+
+    /**
+     * @brief Apply a static coercer to a span, in bulk if it has a `(T*, size_t)` overload.
+     * @param values The values to coerce.
+     * @param count The number of values.
+     */
+    template<typename Coercer, typename T>
+    void CoerceSpan(T* values, size_t count)
+    {
+        if constexpr (is_invocable_v<const Coercer&, T*, size_t>)
+        {
+            Coercer{}(values, count);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                Coercer{}(values[i]);
+        }
+    }
+
+    /**
+     * @brief Find the first value of a span a static validator rejects, in bulk if it has a `(const T*, size_t)` overload.
+     * @param values The values to validate.
+     * @param count The number of values.
+     * @return The index of the first rejected value, or `count` if all are accepted.
+     */
+    template<typename Validator, typename T>
+    size_t FindInvalid(const T* values, size_t count)
+    {
+        if constexpr (is_invocable_r_v<size_t, const Validator&, const T*, size_t>)
+        {
+            return Validator{}(values, count);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                if (!Validator{}(values[i]))
+                    return i;
+            return count;
+        }
+    }
+}
+
+/**
+ * @brief Lock policy giving every property its own mutex.
+ */
+struct InstanceLock
+{
+    /// Type of the mutex guarding the property.
+    using Mutex = mutex;
+
+    /// Whether a thread holding the lock may lock it again.
+    static constexpr bool Reentrant = false;
+
+    /// Guard taken by readers that need the lock.
+    using ReadGuard = lock_guard<Mutex>;
+
+    /**
+     * @brief Get the mutex guarding a property.
+     * @param owner The property.
+     * @return The mutex of this property.
+     */
+    Mutex& GetMutex([[maybe_unused]] const void* owner) const
+    {
+        return m_mutex;
+    }
+
+private:
+    mutable mutex m_mutex; /// Mutex for thread-safe access.
+};
+
+/**
+ * @brief Lock policy sharing a fixed table of mutexes between all properties.
+ *
+ * Takes no space in the property: its address picks one of the stripes. The
+ * stripes are recursive, so two properties that happen to share a stripe can
+ * still be locked one inside the other (bindings, callbacks touching other
+ * properties).
+ */
+struct StripedLock
+{
+    /// Type of the mutex guarding the property.
+    using Mutex = recursive_mutex;
+
+    /// Whether a thread holding the lock may lock it again.
+    static constexpr bool Reentrant = true;
+
+    /// Guard taken by readers that need the lock.
+    using ReadGuard = lock_guard<Mutex>;
+
+    /// Number of mutexes in the table.
+    static constexpr size_t StripeCount = 256;
+
+    /**
+     * @brief Get the mutex guarding a property.
+     * @param owner The property.
+     * @return The stripe the property maps to.
+     */
+    Mutex& GetMutex(const void* owner) const
+    {
+        const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner));
+        return s_stripes[(address * 0x9E3779B97F4A7C15ull) >> 56].mutex; // Fibonacci hashing into 256 stripes.
+    }
+
+private:
+    struct alignas(64) Stripe
+    {
+        recursive_mutex mutex; /// One mutex per cache line.
+    };
+
+    static inline Stripe s_stripes[StripeCount]; /// The shared table.
+};
+
+/**
+ * @brief Lock policy for properties only ever used from one thread.
+ *
+ * Locking compiles to nothing and the property stores no lock. Callbacks may
+ * re-enter the property, so they always iterate a snapshot of the callback list.
+ */
+struct NullLock
+{
+    /**
+     * @brief Mutex whose operations do nothing.
+     */
+    struct Mutex
+    {
+        void lock() {}
+        bool try_lock() { return true; }
+        void unlock() {}
+    };
+
+    /// Whether a thread holding the lock may lock it again.
+    static constexpr bool Reentrant = true;
+
+    /// Guard taken by readers that need the lock.
+    using ReadGuard = lock_guard<Mutex>;
+
+    /**
+     * @brief Get the mutex guarding a property.
+     * @param owner The property.
+     * @return A shared mutex that does nothing.
+     */
+    Mutex& GetMutex([[maybe_unused]] const void* owner) const
+    {
+        static Mutex s_mutex;
+        return s_mutex;
+    }
+};
+
+/**
+ * @brief Lock policy giving every property its own one-byte spinlock.
+ *
+ * For properties whose critical sections are a few stores, where parking a
+ * thread in the kernel would cost more than spinning. Spins briefly, then
+ * yields. Not suited to slow callbacks notified inside the lock.
+ */
+struct SpinLock
+{
+    /**
+     * @brief Test-and-test-and-set spin mutex.
+     */
+    struct Mutex
+    {
+        void lock()
+        {
+            for (size_t spins = 0; !try_lock(); ++spins)
+            {
+                while (m_locked.load(memory_order_relaxed))
+                    if (++spins > 64)
+                        this_thread::yield(); // Let the holder run.
+            }
+        }
+
+        bool try_lock()
+        {
+            return !m_locked.exchange(true, memory_order_acquire);
+        }
+
+        void unlock()
+        {
+            m_locked.store(false, memory_order_release);
+        }
+
+    private:
+        atomic<bool> m_locked{ false }; /// Set while the lock is held.
+    };
+
+    /// Whether a thread holding the lock may lock it again.
+    static constexpr bool Reentrant = false;
+
+    /// Guard taken by readers that need the lock.
+    using ReadGuard = lock_guard<Mutex>;
+
+    /**
+     * @brief Get the mutex guarding a property.
+     * @param owner The property.
+     * @return The spinlock of this property.
+     */
+    Mutex& GetMutex([[maybe_unused]] const void* owner) const
+    {
+        return m_mutex;
+    }
+
+private:
+    mutable Mutex m_mutex; /// Spinlock for thread-safe access.
+};
+
+/**
+ * @brief Lock policy for read-mostly properties.
+ *
+ * Every property owns a `std::shared_mutex`. Readers that need the lock (see
+ * `LockedStorage`) share it, writers and callback registration take it exclusively.
+ */
+struct SharedLock
+{
+    /// Type of the mutex guarding the property.
+    using Mutex = shared_mutex;
+
+    /// Whether a thread holding the lock may lock it again.
+    static constexpr bool Reentrant = false;
+
+    /// Guard taken by readers that need the lock.
+    using ReadGuard = shared_lock<Mutex>;
+
+    /**
+     * @brief Get the mutex guarding a property.
+     * @param owner The property.
+     * @return The mutex of this property.
+     */
+    Mutex& GetMutex([[maybe_unused]] const void* owner) const
+    {
+        return m_mutex;
+    }
+
+private:
+    mutable shared_mutex m_mutex; /// Mutex for thread-safe access.
+};
+
+/**
+ * @brief Default set of policies used by `Property<T>`.
+ *
+ * Derive from it and override the members you want to change, e.g.
+ * `struct MyPolicy : PropertyPolicy<string> { using Storage = SnapshotStorage<string>; };`
+ */
+template<typename T>
+struct PropertyPolicy
+{
+    /// Storage used for the value. See `LockedStorage`, `AtomicStorage`, `SeqLockStorage` and `SnapshotStorage`.
+    using Storage = DefaultStorage<T>;
+
+    /// Wrapper used for change callbacks, validators and coerce callbacks. See `InplaceFunction`.
+    template<typename Signature>
+    using Function = function<Signature>;
+
+    /// Validator checked at compile time, before the runtime validator. See `AcceptAll` and `InRange`.
+    using StaticValidator = AcceptAll;
+
+    /// Coercer applied at compile time, before the runtime coerce callback. See `NoCoercion` and `Clamp`.
+    using StaticCoercer = NoCoercion;
+
+    /// Whether a runtime validator and coerce callback can be set. Disable to drop their storage.
+    static constexpr bool DynamicValidation = true;
+
+    /// Whether callbacks and bindings are notified after the property lock is released.
+    static constexpr bool NotifyOutsideLock = false;
+
+    /// Decides whether a write changes the value. See `NotEqual`, `AlwaysChanged` and `CompareBy`.
+    using Comparator = NotEqual;
+
+    /// Unsigned type counting the changes of the value. `uint32_t` saves space in small properties.
+    using VersionCounter = uint64_t;
+
+    /// Where the property lock comes from. See `InstanceLock`, `StripedLock`, `NullLock`, `SpinLock` and `SharedLock`.
+    using Lock = InstanceLock;
+
+    /// Allocator for the side block, callback lists and binding state. Use `pmr::polymorphic_allocator<byte>` to draw them from an arena.
+    using Allocator = allocator<byte>;
+
+    /// Whether the property keeps `PropertyStats`. Defaults to on only when `PROPERTY_INSTRUMENTATION` is defined.
+#ifdef PROPERTY_INSTRUMENTATION
+    static constexpr bool Instrumented = true;
+#else
+    static constexpr bool Instrumented = false;
+#endif
+};
+
+/**
+ * @brief Policies for a property whose validation is fixed at compile time.
+ *
+ * The validator and coercer are stateless function objects inlined into the
+ * assignment path; runtime validators and coerce callbacks are disabled.
+ */
+template<typename T, typename Validator = AcceptAll, typename Coercer = NoCoercion>
+struct StaticPropertyPolicy : PropertyPolicy<T>
+{
+    using StaticValidator = Validator;
+    using StaticCoercer = Coercer;
+    static constexpr bool DynamicValidation = false;
+};
+
+/**
+ * @brief Scope deferring the change notifications of every property written on this thread.
+ *
+ * While a suppressor is alive, writes on its thread store their values and
+ * bump the versions as usual, but change callbacks and bindings are not run.
+ * When the outermost suppressor of the thread is destroyed, the deferred
+ * notifications are delivered in the order the properties first changed:
+ *
+ * - `Delivery::Final` (the default) notifies each property once, with its value
+ *   from before the first change and its current value, and skips properties
+ *   that ended where they started;
+ * - `Delivery::Every` replays every change in order.
+ *
+ * The delivery of the outermost scope applies to nested ones. Properties
+ * destroyed inside the scope are skipped. Writes made by other threads, and
+ * values received through bindings from them, are not deferred.
+ */
+struct NotificationSuppressor
+{
+    /**
+     * @brief Which deferred notifications are delivered when the scope exits.
+     */
+    enum class Delivery
+    {
+        Final, /// One notification per property, carrying its final state.
+        Every, /// Every change, in order.
+    };
+
+    /**
+     * @brief A deferred notification of one property.
+     */
+    struct Pending
+    {
+        virtual ~Pending() = default;
+
+        /**
+         * @brief Run the notification now.
+         */
+        virtual void Deliver() = 0;
+
+        bool propagate = false; /// Whether to update bound properties.
+    };
+
+    /**
+     * @brief Constructor. Starts deferring on this thread.
+     * @param delivery Which notifications to deliver, unless an outer scope already decided.
+     */
+    explicit NotificationSuppressor(Delivery delivery = Delivery::Final)
+    {
+        State& state = GetState();
+        if (state.depth++ == 0)
+            state.delivery = delivery;
+    }
+
+    NotificationSuppressor(const NotificationSuppressor&) = delete;
+    NotificationSuppressor& operator=(const NotificationSuppressor&) = delete;
+
+    /**
+     * @brief Destructor. The outermost scope delivers the deferred notifications.
+     */
+    ~NotificationSuppressor()
+    {
+        State& state = GetState();
+        if (--state.depth > 0)
+            return;
+        vector<unique_ptr<Pending>> pending;
+        pending.swap(state.pending); // Callbacks may open scopes of their own.
+        state.index.clear();
+        for (const unique_ptr<Pending>& notification : pending)
+            notification->Deliver();
+    }
+
+    /**
+     * @brief Check whether notifications are being deferred on this thread.
+     */
+    static bool Active()
+    {
+        return GetState().depth > 0;
+    }
+
+    /**
+     * @brief Defer a notification. Used by `Property`.
+     * @param key Identifies the property; later notifications of the same key are merged in `Final` mode.
+     * @param propagate Whether to update bound properties.
+     * @param make Called as `make(bool keepNewValue)` to create the `Pending` notification when needed.
+     */
+    template<typename Make>
+    static void Defer(const void* key, bool propagate, Make&& make)
+    {
+        State& state = GetState();
+        if (state.delivery == Delivery::Final)
+        {
+            const auto [found, added] = state.index.try_emplace(key, state.pending.size());
+            if (!added)
+            {
+                state.pending[found->second]->propagate |= propagate; // Keep the first old value.
+                return;
+            }
+        }
+        state.pending.push_back(make(state.delivery == Delivery::Every));
+        state.pending.back()->propagate = propagate;
+    }
+
+private:
+    struct State
+    {
+        size_t depth = 0; /// Number of live suppressors on the thread.
+        Delivery delivery = Delivery::Final; /// Delivery chosen by the outermost suppressor.
+        vector<unique_ptr<Pending>> pending; /// Deferred notifications, in order.
+        unordered_map<const void*, size_t> index; /// Position of each property in `pending`, in `Final` mode.
+    };
+
+    static State& GetState()
+    {
+        static thread_local State state;
+        return state;
+    }
+};
+
+struct PropertyArchive;
+
+namespace PropertyInternals
+{
+    /**
+     * @brief Holds a stateful allocator; empty, so free as a base, for stateless ones.
+     */
+    template<typename Allocator, bool Stateless = is_empty_v<Allocator> && is_default_constructible_v<Allocator>>
+    struct AllocatorHolder
+    {
+        explicit AllocatorHolder(const Allocator&) {}
+        Allocator GetAllocator() const { return Allocator(); }
+    };
+
+    template<typename Allocator>
+    struct AllocatorHolder<Allocator, false>
+    {
+        explicit AllocatorHolder(const Allocator& allocator) : m_allocator(allocator) {}
+        Allocator GetAllocator() const { return m_allocator; }
+
+        Allocator m_allocator; /// The allocator.
+    };
+
+    /**
+     * @brief Read a trivially copyable value from possibly unaligned memory.
+     * @param bytes Where the `sizeof(T)` bytes of the value are.
+     * @return The value.
+     */
+    template<typename T>
+    T FromBytes(const void* bytes)
+    {
+        static_assert(is_trivially_copyable_v<T>, "Only trivially copyable values can be read from raw memory.");
+        alignas(T) unsigned char raw[sizeof(T)];
+        memcpy(raw, bytes, sizeof(T));
+        return *reinterpret_cast<const T*>(raw);
+    }
+}
+
+template<typename T, typename Policy = PropertyPolicy<T>>
+struct Property : private BindingNode, private Policy::Lock, private PropertyInternals::Instrumentation<Policy::Instrumented>,
+    private PropertyInternals::AllocatorHolder<typename Policy::Allocator>
+{
+public:
+    /**
+     * @brief Type definition for change callback function.
+     *
+     * The function signature should be:
+     * void callback(T& oldValue, T& newValue);
+     *
+     * @param oldValue The old value before the change.
+     * @param newValue The new value after the change.
+     */
+    using ChangeCallback = typename Policy::template Function<void(T& oldValue, T& newValue)>;
+
+    /**
+     * @brief Type definition for value validator function.
+     *
+     * The function signature should be:
+     * bool validator(T& newValue);
+     *
+     * @param newValue The new value to be validated.
+     * @return true if the value is valid, false otherwise.
+     */
+    using Validator = typename Policy::template Function<bool(T& newValue)>;
+
+    /**
+     * @brief Type definition for coercion callback function.
+     *
+     * The function signature should be:
+     * void coerceCallback(T& newValue);
+     *
+     * @param newValue The new value that will be coerced.
+     */
+    using CoerceCallback = typename Policy::template Function<void(T& newValue)>;
+
+    /**
+     * @brief Type definition for callback IDs.
+     *
+     * Used to uniquely identify callbacks.
+     */
+    using CallbackID = typename CallbackRegistry<ChangeCallback>::ID;
+
+    /**
+     * @brief Type definition for the storage policy of the value.
+     */
+    using Storage = typename Policy::Storage;
+
+    /**
+     * @brief Type definition for the change counter returned by `Version`.
+     */
+    using VersionCounter = typename Policy::VersionCounter;
+
+    /**
+     * @brief Type definition for the allocator of the side block, callback lists and binding state.
+     */
+    using Allocator = typename Policy::Allocator;
+
+private:
+    template<typename, typename>
+    friend struct Property;
+    friend struct PropertyArchive;
+    template<typename, typename>
+    friend struct SharedProperty;
+#ifdef PROPERTY_COROUTINES
+    template<typename, typename, typename>
+    friend struct PropertyChangeAwaiter;
+#endif
+
+    using DynamicValidation = PropertyInternals::DynamicValidation<Validator, CoerceCallback, Policy::DynamicValidation>;
+    template<typename U>
+    using Rebind = typename allocator_traits<Allocator>::template rebind_alloc<U>;
+    using AllocatorHolder = PropertyInternals::AllocatorHolder<Allocator>;
+    using CallbackVector = vector<pair<CallbackID, ChangeCallback>, Rebind<pair<CallbackID, ChangeCallback>>>;
+    using CallbackList = shared_ptr<const CallbackVector>;
+    using EdgeList = vector<Edge, Rebind<Edge>>;
+    using Mutex = typename Policy::Lock::Mutex;
+    using Instrumentation = PropertyInternals::Instrumentation<Policy::Instrumented>;
+    using InstrumentationHandle = typename Instrumentation::Handle;
+
+    /**
+     * @brief Everything an observed property needs beyond its value.
+     *
+     * Allocated on first use (callback, binding, validator, dispatcher or batch),
+     * so a property nobody observes is only its value, a pointer and its lock.
+     */
+    struct Observers : DynamicValidation, AllocatorHolder
+    {
+        template<typename... Arguments>
+        explicit Observers(const Allocator& allocator, Arguments&&... arguments)
+            : DynamicValidation(std::forward<Arguments>(arguments)...), AllocatorHolder(allocator),
+              callbacks(Rebind<ChangeCallback>(allocator)), bindings(Rebind<Edge>(allocator)) {}
+
+        CallbackRegistry<ChangeCallback, 3, Rebind<ChangeCallback>> callbacks; /// Registry of change callbacks with their IDs.
+        CallbackList callbackSnapshot; /// Immutable copy of the callbacks, shared with in-flight notifications.
+        EdgeList bindings; /// Bindings from this property to other properties.
+        shared_ptr<PropertyDispatcher> dispatcher; /// Executor the change callbacks are posted to, if any.
+        size_t updateDepth = 0; /// Nesting depth of BeginUpdate calls.
+        optional<T> pendingOldValue; /// Value from before the first change of the current batch.
+        shared_ptr<Subscription::Link> subscriptionLink; /// Shared with the tokens returned by Subscribe.
+        shared_ptr<BindingAnchor> anchor; /// Set once the property is a source or target of a binding; writes are then stamped.
+        shared_ptr<BindingAnchor> liveness; /// Set once a notification is deferred; tells deferred notifications whether the property is alive.
+        atomic<uint64_t> stamp{ 0 }; /// Stamp of the write the value comes from. Written under the lock.
+#ifdef PROPERTY_COROUTINES
+        shared_ptr<PropertyInternals::WaitList<T>> waiters; /// Coroutines waiting for a change, fed by one callback.
+#endif
+    };
+
+    /**
+     * @brief Destroys and frees a side block with the allocator it was made with.
+     */
+    struct ObserversDeleter
+    {
+        void operator()(Observers* observers) const
+        {
+            Rebind<Observers> allocator(observers->GetAllocator());
+            allocator_traits<Rebind<Observers>>::destroy(allocator, observers);
+            allocator_traits<Rebind<Observers>>::deallocate(allocator, observers, 1);
+        }
+    };
+
+    Storage m_storage; /// The current value of the property.
+
+    /// Whether notifications can refer to the stored value instead of a copy: callbacks then run under a lock that writes from them cannot re-enter.
+    static constexpr bool NotifyInPlace = Storage::InPlaceAccess && !Policy::NotifyOutsideLock && !Policy::Lock::Reentrant;
+
+    atomic<VersionCounter> m_version{ 0 }; /// Number of changes committed so far, wrapping around.
+    unique_ptr<Observers, ObserversDeleter> m_observers; /// Callbacks, bindings and validation, null until needed.
+
+public:
+    /**
+     * @brief Default constructor.
+     * @param value The initial value of the property.
+     */
+    Property(T value = T()) : AllocatorHolder(Allocator()), m_storage(value) {}
+
+    /**
+     * @brief Constructor with an allocator for the side block, callback lists and binding state.
+     * @param allocator The allocator, e.g. a `pmr::polymorphic_allocator<byte>` over an arena.
+     * @param value The initial value of the property.
+     */
+    Property(allocator_arg_t, const Allocator& allocator, T value = T()) : AllocatorHolder(allocator), m_storage(value) {}
+
+    /**
+     * @brief Constructor with validator.
+     * @param validator The validator function for new values.
+     */
+    Property(Validator validator) : AllocatorHolder(Allocator()), m_observers(MakeObservers(validator))
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime validator.");
+    }
+
+    /**
+     * @brief Constructor with coercion callback.
+     * @param coerceCallback The coercion callback function.
+     */
+    Property(CoerceCallback coerceCallback) : AllocatorHolder(Allocator()), m_observers(MakeObservers(Validator(), coerceCallback))
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime coerce callback.");
+    }
+
+    /**
+     * @brief Constructor with initial value and validator.
+     * @param value The initial value of the property.
+     * @param validator The validator function for new values.
+     */
+    Property(T value, Validator validator) : AllocatorHolder(Allocator()), m_storage(value), m_observers(MakeObservers(validator))
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime validator.");
+    }
+
+    /**
+     * @brief Constructor with initial value and coercion callback.
+     * @param value The initial value of the property.
+     * @param coerceCallback The coercion callback function.
+     */
+    Property(T value, CoerceCallback coerceCallback)
+        : AllocatorHolder(Allocator()), m_storage(value), m_observers(MakeObservers(Validator(), coerceCallback))
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime coerce callback.");
+    }
+
+    /**
+     * @brief Constructor with initial value, validator, and coercion callback.
+     * @param value The initial value of the property.
+     * @param validator The validator function for new values.
+     * @param coerceCallback The coercion callback function.
+     */
+    Property(T value, Validator validator, CoerceCallback coerceCallback)
+        : AllocatorHolder(Allocator()), m_storage(value), m_observers(MakeObservers(validator, coerceCallback))
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime validator or coerce callback.");
+    }
+
+    /**
+     * @brief Destructor. Empties the tokens returned by `Subscribe`.
+     */
+    ~Property()
+    {
+        if (m_observers && m_observers->anchor)
+            m_observers->anchor->Retire(); // Unbinds from both ends, once propagations using it are done.
+        if (m_observers && m_observers->liveness)
+            m_observers->liveness->Retire(); // Drops deferred notifications, once one being delivered is done.
+        if (m_observers && m_observers->subscriptionLink)
+        {
+            lock_guard<mutex> lock(m_observers->subscriptionLink->linkMutex); // Wait for tokens removing a callback.
+            m_observers->subscriptionLink->owner = nullptr;
+        }
+    }
+
+    /**
+     * @brief Assignment operator to set a new value by copying it.
+     * @param newValue The new value to assign.
+     * @return A reference to this property.
+     */
+    Property& operator=(const T& newValue)
+    {
+        Set(newValue);
+        return *this;
+    }
+
+    /**
+     * @brief Assignment operator to set a new value by moving it.
+     * @param newValue The new value to assign.
+     * @return A reference to this property.
+     */
+    Property& operator=(T&& newValue)
+    {
+        Set(std::move(newValue));
+        return *this;
+    }
+
+    /**
+     * @brief Set a new value by copying it.
+     * @param newValue The new value to assign.
+     * @return true if the value was changed, false otherwise.
+     */
+    bool Set(const T& newValue)
+    {
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        this->RecordWrite();
+        if (!Differs(newValue))
+            return false; // An unchanged value is never copied.
+        return Assign(lock, T(newValue), true);
+    }
+
+    /**
+     * @brief Set a new value by moving it.
+     *
+     * When no callbacks or bindings are registered the new value is moved
+     * straight into the property and the old value is never preserved.
+     * Otherwise the old value is moved out (not copied) for the notifications.
+     *
+     * @param newValue The new value to assign.
+     * @return true if the value was changed, false otherwise.
+     */
+    bool Set(T&& newValue)
+    {
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        this->RecordWrite();
+        if (!Differs(newValue))
+            return false;
+        return Assign(lock, std::move(newValue), true);
+    }
+
+    /**
+     * @brief Set a new value without notifying callbacks or bound properties.
+     *
+     * The value is still coerced and validated, and the version is bumped, so
+     * pollers see the change. Meant for bulk initialization.
+     *
+     * @param newValue The new value to assign.
+     * @return true if the value was changed, false otherwise.
+     */
+    bool SetSilently(const T& newValue)
+    {
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        this->RecordWrite();
+        if (!Differs(newValue))
+            return false; // An unchanged value is never copied.
+        return Assign(lock, T(newValue), false);
+    }
+
+    /**
+     * @brief Set a new value by moving it, without notifying callbacks or bound properties.
+     * @param newValue The new value to assign.
+     * @return true if the value was changed, false otherwise.
+     */
+    bool SetSilently(T&& newValue)
+    {
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        this->RecordWrite();
+        if (!Differs(newValue))
+            return false;
+        return Assign(lock, std::move(newValue), false);
+    }
+
+    /**
+     * @brief Start coalescing changes.
+     *
+     * Until the matching `EndUpdate`, changes are stored but not notified.
+     * Calls nest; only the outermost `EndUpdate` notifies.
+     */
+    void BeginUpdate()
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        ++GetObservers().updateDepth;
+    }
+
+    /**
+     * @brief Stop coalescing changes.
+     *
+     * The outermost call sends a single notification carrying the value from
+     * before the first change and the current value, unless they are equal.
+     */
+    void EndUpdate()
+    {
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        if (!m_observers || m_observers->updateDepth == 0 || --m_observers->updateDepth > 0 || !m_observers->pendingOldValue)
+            return;
+        T oldValue = std::move(*m_observers->pendingOldValue);
+        m_observers->pendingOldValue.reset();
+        T newValue = m_storage.Load();
+        if (typename Policy::Comparator{}(oldValue, newValue))
+            Notify(lock, oldValue, newValue); // Notify callbacks and bound properties.
+    }
+
+    /**
+     * @brief Get the current value.
+     *
+     * Does not take the lock when the storage policy supports lock-free reads.
+     *
+     * @return A copy of the current value of the property.
+     */
+    T Get() const
+    {
+        if constexpr (Storage::LockFreeReads)
+        {
+            return m_storage.Load();
+        }
+        else
+        {
+            typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+            return m_storage.Load();
+        }
+    }
+
+    /**
+     * @brief Get the current snapshot without copying the value.
+     *
+     * Only available when the storage policy publishes snapshots (see `SnapshotStorage`).
+     *
+     * @return A shared pointer to the current immutable value.
+     */
+    template<typename S = Storage>
+    auto Snapshot() const -> decltype(declval<const S&>().Snapshot())
+    {
+        return m_storage.Snapshot();
+    }
+
+    /**
+     * @brief Get the number of changes committed so far.
+     *
+     * Grows by one on every change, including each change coalesced into a batch,
+     * so comparing versions detects a change without comparing values. A single
+     * atomic load; a reader that sees a version also sees the value it counts.
+     *
+     * @return The version of the current value.
+     */
+    VersionCounter Version() const
+    {
+        return m_version.load(memory_order_acquire);
+    }
+
+    /**
+     * @brief Check whether the value changed since a version was read.
+     * @param version A version returned by `Version` or updated by `Poll`.
+     * @return true if at least one change was committed since.
+     */
+    bool ChangedSince(VersionCounter version) const
+    {
+        return Version() != version;
+    }
+
+    /**
+     * @brief Check for changes since the last poll and remember the current version.
+     *
+     * Meant for render loops and samplers: call once per frame with the same
+     * counter, and re-read the value only when it returns true.
+     *
+     * @param lastSeen The version seen by the previous poll; updated to the current one.
+     * @return true if the value changed since the previous poll.
+     */
+    bool Poll(VersionCounter& lastSeen) const
+    {
+        const VersionCounter current = Version();
+        if (current == lastSeen)
+            return false;
+        lastSeen = current;
+        return true;
+    }
+
+    /**
+     * @brief Get the write counters and latency histograms of the property.
+     *
+     * Only available when `Policy::Instrumented` is true. The statistics are
+     * also listed in `PropertyStatsRegistry` for exporting.
+     *
+     * @return The statistics, shared with in-flight notifications.
+     */
+    const shared_ptr<PropertyStats>& Stats() const
+    {
+        static_assert(Policy::Instrumented, "Stats() requires an instrumented policy; define PROPERTY_INSTRUMENTATION or set Policy::Instrumented.");
+        return this->StatsHandle();
+    }
+
+    /**
+     * @brief Conversion operator to get the value.
+     * @return The current value of the property.
+     */
+    operator T() const
+    {
+        return Get();
+    }
+
+    /**
+     * @brief Arrow operator to access members of the underlying value.
+     * 
+     * This operator allows direct access to the members of the underlying value
+     * if the type `T` is a class or struct. It returns the underlying value.
+     *
+     * @return The current value of the property.
+     */
+    T operator->()
+    {
+        return (T)this;
+    }
+
+    /**
+     * @brief Add a change callback and return its ID.
+     * @param callback The callback function to add.
+     * @return The ID of the added callback.
+     */
+    CallbackID AddChangeCallback(ChangeCallback callback)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        Observers& observers = GetObservers();
+        observers.callbackSnapshot.reset(); // The snapshot is rebuilt on the next change.
+        return observers.callbacks.Add(std::move(callback)); // Store the callback and return its ID.
+    }
+
+    /**
+     * @brief Add a change callback that stays registered as long as the returned token.
+     *
+     * Prefer this for short-lived subscribers: destroying the token removes the
+     * callback in O(1), and the token is safe to outlive the property.
+     *
+     * @param callback The callback function to add.
+     * @return The token owning the registration.
+     */
+    [[nodiscard]] Subscription Subscribe(ChangeCallback callback)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        Observers& observers = GetObservers();
+        if (!observers.subscriptionLink)
+        {
+            observers.subscriptionLink = allocate_shared<Subscription::Link>(this->GetAllocator());
+            observers.subscriptionLink->owner = this;
+            observers.subscriptionLink->remove = [](void* owner, size_t id) { static_cast<Property*>(owner)->RemoveChangeCallback(id); };
+        }
+        observers.callbackSnapshot.reset(); // The snapshot is rebuilt on the next change.
+        return Subscription(observers.subscriptionLink, observers.callbacks.Add(std::move(callback)));
+    }
+
+    /**
+     * @brief Remove a change callback using the callback function.
+     *
+     * Scans every callback and only finds function pointers, not lambdas;
+     * prefer removing by ID or through a `Subscription`.
+     *
+     * @param callback The callback function to remove.
+     */
+    void RemoveChangeCallback(ChangeCallback callback)
+    {
+        using Pointer = void (*)(T&, T&);
+        const Pointer* wanted = callback.template target<Pointer>();
+        if (!wanted)
+            return; // Only function pointers can be compared.
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (!m_observers)
+            return;
+        m_observers->callbackSnapshot.reset(); // The snapshot is rebuilt on the next change.
+        m_observers->callbacks.RemoveFirst([&](const ChangeCallback& candidate)
+        {
+            const Pointer* found = candidate.template target<Pointer>();
+            return found && *found == *wanted;
+        });
+    }
+
+    /**
+     * @brief Remove a change callback using its ID.
+     * @param id The ID of the callback to remove.
+     */
+    void RemoveChangeCallback(CallbackID id)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (m_observers && m_observers->callbacks.Remove(id)) // Remove the callback if it still exists.
+        {
+            m_observers->callbackSnapshot.reset(); // The snapshot is rebuilt on the next change.
+            this->ForgetCallback(id);
+        }
+    }
+
+    /**
+     * @brief Add a one-way binding to another property.
+     * @param other The other property to bind to.
+     */
+    void AddOneWayBind(Property& other)
+    {
+        shared_ptr<BindingAnchor> target = other.Anchor(); // Before the edge is visible, so the target is ready to receive.
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        AnchorLocked();
+        EdgeList& bindings = m_observers->bindings;
+        if (none_of(bindings.begin(), bindings.end(), [&](const Edge& edge) { return edge.target == target; }))
+            bindings.push_back({ std::move(target), &ApplyBinding, &BindingEdges, nullptr }); // Add to bindings.
+    }
+
+    /**
+     * @brief Remove a one-way binding to another property.
+     * @param other The other property to unbind.
+     */
+    void RemoveOneWayBind(Property& other)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (!m_observers)
+            return;
+        EdgeList& bindings = m_observers->bindings;
+        const BindingNode* target = &other;
+        bindings.erase(remove_if(bindings.begin(), bindings.end(),
+            [&](const Edge& edge) { return edge.target->Node() == target; }), bindings.end()); // Remove from bindings.
+    }
+
+    /**
+     * @brief Add a one-way-to-source binding to another property.
+     * @param other The other property to bind with this property.
+     */
+    void AddOneWayToSourceBind(Property& other)
+    {
+        other.AddOneWayBind(*this); // Add this property to the other property's bindings.
+    }
+
+    /**
+     * @brief Remove a one-way-to-source binding from another property.
+     * @param other The other property to unbind from this property.
+     */
+    void RemoveOneWayToSourceBind(Property& other)
+    {
+        other.RemoveOneWayBind(*this); // Remove this property from the other property's bindings.
+    }
+
+    /**
+     * @brief Add a two-way binding with another property.
+     * @param other The other property to bind with.
+     */
+    void AddBind(Property& other)
+    {
+        AddOneWayBind(other); // Add one-way binding to the other property.
+        AddOneWayToSourceBind(other); // Add one-way-to-source binding with the other property.
+    }
+
+    /**
+     * @brief Remove a two-way binding with another property.
+     * @param other The other property to unbind.
+     */
+    void RemoveBind(Property& other)
+    {
+        RemoveOneWayBind(other); // Remove one-way binding to the other property.
+        RemoveOneWayToSourceBind(other); // Remove one-way-to-source binding with the other property.
+    }
+
+    /**
+     * @brief Add a one-way binding to a property of another type.
+     *
+     * Changes of this property are converted and pushed into `other` by the
+     * binding graph like any other binding. Binding the same property again
+     * replaces the converter.
+     *
+     * @param other The other property to bind to.
+     * @param converter Function object turning a `const T&` into a value convertible to `U`.
+     */
+    template<typename U, typename Q, typename Converter>
+    void AddOneWayBind(Property<U, Q>& other, Converter converter)
+    {
+        shared_ptr<BindingAnchor> target = other.Anchor(); // Before the edge is visible, so the target is ready to receive.
+        shared_ptr<const void> context = allocate_shared<Converter>(this->GetAllocator(), std::move(converter));
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        AnchorLocked();
+        EdgeList& bindings = m_observers->bindings;
+        auto found = find_if(bindings.begin(), bindings.end(), [&](const Edge& edge) { return edge.target == target; });
+        Edge edge{ std::move(target), &ApplyConvertedBinding<U, Q, Converter>, &Property<U, Q>::BindingEdges, std::move(context) };
+        if (found != bindings.end())
+            *found = std::move(edge); // Replace the converter.
+        else
+            bindings.push_back(std::move(edge)); // Add to bindings.
+    }
+
     /**
-     * @brief Type definition for change callback function.
-     *
-     * The function signature should be:
-     * void callback(T& oldValue, T& newValue);
-     *
-     * @param oldValue The old value before the change.
-     * @param newValue The new value after the change.
+     * @brief Remove a one-way binding to a property of another type.
+     * @param other The other property to unbind.
      */
-    using ChangeCallback = function<void(T& oldValue, T& newValue)>;
+    template<typename U, typename Q>
+    void RemoveOneWayBind(Property<U, Q>& other)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (!m_observers)
+            return;
+        EdgeList& bindings = m_observers->bindings;
+        const BindingNode* target = &other;
+        bindings.erase(remove_if(bindings.begin(), bindings.end(),
+            [&](const Edge& edge) { return edge.target->Node() == target; }), bindings.end()); // Remove from bindings.
+    }
 
     /**
-     * @brief Type definition for value validator function.
+     * @brief Add a two-way binding with a property of another type.
+     * @param other The other property to bind with.
+     * @param toOther Converts values of this property for `other`.
+     * @param fromOther Converts values of `other` for this property.
+     */
+    template<typename U, typename Q, typename ToOther, typename FromOther>
+    void AddBind(Property<U, Q>& other, ToOther toOther, FromOther fromOther)
+    {
+        AddOneWayBind(other, std::move(toOther)); // Add one-way binding to the other property.
+        other.AddOneWayBind(*this, std::move(fromOther)); // Add the binding back from the other property.
+    }
+
+    /**
+     * @brief Remove a two-way binding with a property of another type.
+     * @param other The other property to unbind.
+     */
+    template<typename U, typename Q>
+    void RemoveBind(Property<U, Q>& other)
+    {
+        RemoveOneWayBind(other); // Remove one-way binding to the other property.
+        other.RemoveOneWayBind(*this); // Remove the binding back from the other property.
+    }
+
+    /**
+     * @brief Post change callbacks to an executor instead of running them on the writer's thread.
      *
-     * The function signature should be:
-     * bool validator(T& newValue);
+     * Share one dispatcher between several properties to run all of their callbacks
+     * on the same executor. Bindings are still updated on the writer's thread.
      *
-     * @param newValue The new value to be validated.
-     * @return true if the value is valid, false otherwise.
+     * @param dispatcher The executor, or nullptr to run callbacks synchronously again.
      */
-    using Validator = function<bool(T& newValue)>;
+    void SetDispatcher(shared_ptr<PropertyDispatcher> dispatcher)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        GetObservers().dispatcher = std::move(dispatcher); // Set the dispatcher.
+    }
 
+#ifdef PROPERTY_COROUTINES
     /**
-     * @brief Type definition for coercion callback function.
+     * @brief Wait in a coroutine for the next change: `T value = co_await property.Changed();`
      *
-     * The function signature should be:
-     * void coerceCallback(T& newValue);
+     * Waiting costs the coroutine frame and a slot in a list shared by all the
+     * waiters of the property, not a thread or a callback each.
      *
-     * @param newValue The new value that will be coerced.
+     * @param resumeOn Executor to resume on; by default the coroutine resumes where the
+     * change is notified (the property's dispatcher, or the writing thread).
+     * @return An awaitable yielding the new value.
      */
-    using CoerceCallback = function<void(T& newValue)>;
+    PropertyChangeAwaiter<Property, T, PropertyInternals::AnyValue> Changed(shared_ptr<PropertyDispatcher> resumeOn = nullptr)
+    {
+        return { *this, PropertyInternals::AnyValue(), false, std::move(resumeOn) };
+    }
 
     /**
-     * @brief Type definition for callback IDs.
+     * @brief Wait in a coroutine until the value satisfies a predicate: `co_await level.When([](int v) { return v > 3; });`
      *
-     * Used to uniquely identify callbacks.
+     * Completes without suspending if the current value already satisfies it.
+     *
+     * @param predicate Called as `predicate(const T&)`, with the property lock held.
+     * @param resumeOn Executor to resume on; by default the coroutine resumes where the
+     * change is notified (the property's dispatcher, or the writing thread).
+     * @return An awaitable yielding the accepted value.
      */
-    using CallbackID = size_t;
+    template<typename Predicate>
+    PropertyChangeAwaiter<Property, T, decay_t<Predicate>> When(Predicate&& predicate, shared_ptr<PropertyDispatcher> resumeOn = nullptr)
+    {
+        return { *this, std::forward<Predicate>(predicate), true, std::move(resumeOn) };
+    }
+#endif
 
-private:
-    T m_value; /// The current value of the property.
-    unordered_map<CallbackID, ChangeCallback> m_callbacks; /// Map of change callbacks with their IDs.
-    unordered_set<Property<T>*> m_bindings; /// Set of properties bound to this property.
-    queue<CallbackID> m_availableIDs; /// Queue of available IDs for reuse.
-    CallbackID nextCallbackID = 0; /// ID generator for new callbacks.
-    Validator m_validator; /// Validator function for new values.
-    CoerceCallback m_coerceCallback; /// Coerce callback function for new values.
-    mutable mutex m_mutex; /// Mutex for thread-safe access.
+    /**
+     * @brief Set the validator function for new values.
+     * @param validator The validator function.
+     */
+    void SetValidator(Validator validator)
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime validator.");
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        GetObservers().m_validator = validator; // Set the validator function.
+    }
 
-public:
     /**
-     * @brief Default constructor.
-     * @param value The initial value of the property.
+     * @brief Set the coercion callback function for new values.
+     * @param coerceCallback The coercion callback function.
      */
-    Property(T value = T()) : m_value(value) {}
+    void SetCoerceCallback(CoerceCallback coerceCallback)
+    {
+        static_assert(Policy::DynamicValidation, "This property does not accept a runtime coerce callback.");
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        GetObservers().m_coerceCallback = coerceCallback; // Set the coercion callback function.
+    }
 
+private:
     /**
-     * @brief Constructor with validator.
-     * @param validator The validator function for new values.
+     * @brief Get the mutex guarding this property from the lock policy.
      */
-    Property(Validator validator) : m_validator(validator) {}
+    Mutex& GetMutex() const
+    {
+        return Policy::Lock::GetMutex(this);
+    }
 
     /**
-     * @brief Constructor with coercion callback.
-     * @param coerceCallback The coercion callback function.
+     * @brief Get the side block, allocating it on first use. Must be called with the lock held.
      */
-    Property(CoerceCallback coerceCallback) : m_coerceCallback(coerceCallback) {}
+    Observers& GetObservers()
+    {
+        if (!m_observers)
+            m_observers = MakeObservers();
+        return *m_observers;
+    }
 
     /**
-     * @brief Constructor with initial value and validator.
-     * @param value The initial value of the property.
-     * @param validator The validator function for new values.
+     * @brief Allocate a side block with the allocator of the property.
+     * @param arguments The runtime validator and coerce callback, if any.
      */
-    Property(T value, Validator validator) : m_value(value), m_validator(validator) {}
+    template<typename... Arguments>
+    unique_ptr<Observers, ObserversDeleter> MakeObservers(Arguments&&... arguments) const
+    {
+        Rebind<Observers> allocator(this->GetAllocator());
+        Observers* observers = allocator_traits<Rebind<Observers>>::allocate(allocator, 1);
+        try
+        {
+            allocator_traits<Rebind<Observers>>::construct(allocator, observers, this->GetAllocator(), std::forward<Arguments>(arguments)...);
+        }
+        catch (...)
+        {
+            allocator_traits<Rebind<Observers>>::deallocate(allocator, observers, 1);
+            throw;
+        }
+        return unique_ptr<Observers, ObserversDeleter>(observers);
+    }
 
     /**
-     * @brief Constructor with initial value and coercion callback.
-     * @param value The initial value of the property.
-     * @param coerceCallback The coercion callback function.
+     * @brief Get the binding anchor of the property, creating it if needed.
+     * @return The anchor edges leading to this property hold.
      */
-    Property(T value, CoerceCallback coerceCallback) : m_value(value), m_coerceCallback(coerceCallback) {}
+    shared_ptr<BindingAnchor> Anchor()
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        return AnchorLocked();
+    }
 
     /**
-     * @brief Constructor with initial value, validator, and coercion callback.
-     * @param value The initial value of the property.
-     * @param validator The validator function for new values.
-     * @param coerceCallback The coercion callback function.
+     * @brief Get the binding anchor of the property, creating it if needed. Must be called with the lock held.
      */
-    Property(T value, Validator validator, CoerceCallback coerceCallback)
-        : m_value(value), m_validator(validator), m_coerceCallback(coerceCallback) {}
+    shared_ptr<BindingAnchor>& AnchorLocked()
+    {
+        Observers& observers = GetObservers();
+        if (!observers.anchor)
+            observers.anchor = allocate_shared<BindingAnchor>(this->GetAllocator(), static_cast<BindingNode*>(this));
+        return observers.anchor;
+    }
 
     /**
-     * @brief Assignment operator to set a new value.
-     * @param newValue The new value to assign.
-     * @return A reference to this property.
+     * @brief Coerce, compare and validate a value that differs from the current one, then store it.
+     * @param lock The held property lock; may be released while notifying.
+     * @param newValue The new value; moved from when stored.
+     * @param notify Whether to notify callbacks and bound properties.
+     * @return true if the value was changed, false otherwise.
      */
-    Property<T>& operator=(T& newValue)
+    bool Assign(unique_lock<Mutex>& lock, T&& newValue, bool notify)
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        if (m_value != newValue)
+        Coerce(newValue); // Apply coercion if specified.
+        if (!Differs(newValue)) // Coercion may map the value onto the current one.
+            return false;
+        if (!Validate(newValue)) // Validate if validator is provided.
         {
-            if (m_coerceCallback)
-                m_coerceCallback(newValue); // Apply coercion if specified.
-            if (!m_validator || m_validator(newValue)) // Validate if validator is provided.
-            {
-                T oldValue = m_value; // Store old value.
-                m_value = newValue; // Update to new value.
-                NotifyCallbacks(oldValue, newValue); // Notify callbacks.
-                NotifyBindings(oldValue, newValue); // Notify bound properties.
-            }
+            this->RecordRejected();
+            return false;
         }
-        return *this;
+        if (notify)
+        {
+            Commit(lock, std::move(newValue), true); // Store and notify.
+            return true;
+        }
+        if (m_observers && m_observers->anchor)
+            m_observers->stamp.store(BindingGraph::NextStamp(), memory_order_relaxed); // Older propagated values lose.
+        m_storage.Store(std::move(newValue));
+        BumpVersion();
+        this->RecordChange();
+        return true;
     }
 
     /**
-     * @brief Conversion operator to get the value.
-     * @return The current value of the property.
+     * @brief Store a coerced and validated value, then notify unless batching.
+     * @param lock The held property lock; may be released while notifying.
+     * @param newValue The new value.
+     * @param propagate Whether to propagate the change to bound properties.
      */
-    operator T() const
+    void Commit(unique_lock<Mutex>& lock, T&& newValue, bool propagate)
     {
-        return m_value;
+        Observers* observers = m_observers.get();
+        this->RecordChange();
+        if (propagate && observers && observers->anchor)
+            observers->stamp.store(BindingGraph::NextStamp(), memory_order_relaxed); // A new local write.
+        if (!observers || (observers->callbacks.Empty() && (!propagate || observers->bindings.empty())))
+        {
+            m_storage.Store(std::move(newValue)); // Nobody needs the old value.
+            BumpVersion();
+        }
+        else if (observers->updateDepth > 0)
+        {
+            if (observers->pendingOldValue)
+                m_storage.Store(std::move(newValue)); // Keep the first old value of the batch.
+            else
+                observers->pendingOldValue = m_storage.Exchange(std::move(newValue)); // Notified in EndUpdate.
+            BumpVersion();
+        }
+        else if constexpr (NotifyInPlace)
+        {
+            T oldValue = m_storage.Exchange(std::move(newValue)); // Move the old value out.
+            BumpVersion();
+            Notify(lock, oldValue, m_storage.Current(), propagate); // Notify from the stored value.
+        }
+        else
+        {
+            T oldValue = m_storage.Exchange(T(newValue)); // The storage may not hand out its value.
+            BumpVersion();
+            Notify(lock, oldValue, newValue, propagate); // Notify callbacks and bound properties.
+        }
     }
 
     /**
-     * @brief Arrow operator to access members of the underlying value.
-     * 
-     * This operator allows direct access to the members of the underlying value
-     * if the type `T` is a class or struct. It returns the underlying value.
-     *
-     * @return The current value of the property.
+     * @brief Publish a new version after storing a value. Must be called with the lock held.
      */
-    T operator->()
+    void BumpVersion()
     {
-        return (T)this;
+        m_version.store(m_version.load(memory_order_relaxed) + 1, memory_order_release); // Writers are serialized.
     }
 
     /**
-     * @brief Add a change callback and return its ID.
-     * @param callback The callback function to add.
-     * @return The ID of the added callback.
+     * @brief Notify callbacks and bound properties of a change, honouring the notification mode.
+     *
+     * Bound properties are always updated after the lock is released; see `BindingGraph`.
+     *
+     * @param lock The held property lock; released before propagating to bound properties.
+     * @param oldValue The old value before the change.
+     * @param newValue The new value after the change.
+     * @param propagate Whether to propagate the change to bound properties.
      */
-    CallbackID AddChangeCallback(ChangeCallback callback)
+    void Notify(unique_lock<Mutex>& lock, T& oldValue, T& newValue, bool propagate = true)
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        CallbackID id;
-        if (m_availableIDs.empty())
+        if (NotificationSuppressor::Active())
+            return Defer(lock, oldValue, newValue, propagate);
+        optional<BindingGraph::Propagation> propagation;
+        uint64_t stamp = 0;
+        if (propagate && !m_observers->bindings.empty())
+        {
+            EdgeList& edges = m_observers->bindings;
+            edges.erase(remove_if(edges.begin(), edges.end(),
+                [](const Edge& edge) { return edge.target->Retired(); }), edges.end()); // Prune destroyed targets.
+            propagation.emplace();
+            propagation->Edges().assign(edges.begin(), edges.end()); // Snapshot the bindings under the lock.
+            stamp = m_observers->stamp.load(memory_order_relaxed);
+        }
+        if constexpr (Policy::NotifyOutsideLock)
         {
-            id = nextCallbackID++; // Generate a new ID.
+            CallbackList callbacks = CallbackSnapshot(); // Snapshot the listeners under the lock.
+            shared_ptr<PropertyDispatcher> dispatcher = m_observers->dispatcher;
+            lock.unlock(); // Dispatch without holding the lock.
+            DispatchCallbacks(dispatcher.get(), this->StatsHandle(), callbacks, oldValue, newValue); // Notify callbacks.
         }
         else
         {
-            id = m_availableIDs.front(); // Reuse an available ID.
-            m_availableIDs.pop(); // Remove it from the available IDs queue.
+            PropertyInternals::ResumeGuard resumeAfterUnlock; // Coroutines woken by the callbacks must not run under the lock.
+            NotifyCallbacks(oldValue, newValue); // Notify callbacks.
+            lock.unlock();
+            resumeAfterUnlock.Release();
+        }
+        if (propagation)
+        {
+            const void* rootValue = &newValue;
+            if constexpr (NotifyInPlace)
+                if (&newValue == &m_storage.Current())
+                    rootValue = nullptr; // The stored value may change once unlocked; bound properties read it under the lock.
+            propagation->Run(*this, rootValue, stamp); // Notify bound properties.
         }
-        m_callbacks[id] = callback; // Store the callback with the assigned ID.
-        return id; // Return the ID that was used.
     }
 
     /**
-     * @brief Remove a change callback using the callback function.
-     * @param callback The callback function to remove.
+     * @brief Check with the comparator whether a value differs from the current one. Must be called with the lock held.
+     *
+     * Writes check the raw value first: the current value is already coerced,
+     * so a raw value equal to it stays equal. They check again after coercion.
+     *
+     * @param value The candidate value.
+     * @return true if storing `value` would be a change.
      */
-    void RemoveChangeCallback(ChangeCallback callback)
+    template<typename V>
+    bool Differs(const V& value) const
+    {
+        return m_storage.Visit([&](const T& current) { return typename Policy::Comparator{}(current, value); });
+    }
+
+    /**
+     * @brief Notification of this property held by a `NotificationSuppressor`.
+     */
+    struct DeferredNotification : NotificationSuppressor::Pending
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
+        DeferredNotification(shared_ptr<BindingAnchor> liveness, T oldValue, optional<T> newValue)
+            : liveness(std::move(liveness)), oldValue(std::move(oldValue)), newValue(std::move(newValue)) {}
+
+        void Deliver() override
         {
-            if (callback.target_type() == it->second.target_type() &&
-                callback.target<void(T&, T&)>() == it->second.target<void(T&, T&)>())
-            {
-                m_availableIDs.push(it->first); // Add the ID to the available IDs queue.
-                m_callbacks.erase(it); // Remove the callback and break the loop.
-                break;
-            }
+            BindingNode* node = liveness->Pin();
+            if (!node)
+                return; // The property was destroyed.
+            static_cast<Property*>(node)->DeliverDeferred(oldValue, newValue ? &*newValue : nullptr, propagate);
+            liveness->Unpin();
         }
+
+        shared_ptr<BindingAnchor> liveness; /// Tells whether the property is still alive.
+        T oldValue; /// The value before the first deferred change.
+        optional<T> newValue; /// The value after the change, or empty to read the current value.
+    };
+
+    /**
+     * @brief Hand a notification to the suppressor of this thread.
+     * @param lock The held property lock; released before deferring.
+     * @param oldValue The old value before the change; moved from.
+     * @param newValue The new value after the change.
+     * @param propagate Whether to propagate the change to bound properties.
+     */
+    void Defer(unique_lock<Mutex>& lock, T& oldValue, T& newValue, bool propagate)
+    {
+        shared_ptr<BindingAnchor>& liveness = m_observers->liveness; // Not the binding anchor, which would stamp every later write.
+        if (!liveness)
+            liveness = allocate_shared<BindingAnchor>(this->GetAllocator(), static_cast<BindingNode*>(this));
+        NotificationSuppressor::Defer(liveness.get(), propagate, [&](bool keepNewValue)
+        {
+            return make_unique<DeferredNotification>(liveness, std::move(oldValue), keepNewValue ? optional<T>(newValue) : nullopt);
+        });
+        lock.unlock(); // The new value may be the stored one, so it is copied first.
     }
 
     /**
-     * @brief Remove a change callback using its ID.
-     * @param id The ID of the callback to remove.
+     * @brief Deliver a notification deferred by a `NotificationSuppressor`.
+     * @param oldValue The value before the change.
+     * @param newValue The value after the change, or nullptr to use the current value.
+     * @param propagate Whether to propagate the change to bound properties.
      */
-    void RemoveChangeCallback(CallbackID id)
+    void DeliverDeferred(T& oldValue, T* newValue, bool propagate)
+    {
+        unique_lock<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        T value = newValue ? std::move(*newValue) : m_storage.Load();
+        if (!typename Policy::Comparator{}(oldValue, value))
+            return; // Back where it started.
+        if (propagate && m_observers->anchor)
+            m_observers->stamp.store(BindingGraph::NextStamp(), memory_order_relaxed); // Replayed changes must not look stale.
+        Notify(lock, oldValue, value, propagate); // Notify callbacks and bound properties.
+    }
+
+    /**
+     * @brief Apply the static coercer, then the coerce callback if one is set.
+     * @param value The value to coerce.
+     */
+    void Coerce(T& value)
+    {
+        typename Policy::StaticCoercer{}(value);
+        if constexpr (Policy::DynamicValidation)
+            if (m_observers && m_observers->m_coerceCallback)
+                m_observers->m_coerceCallback(value);
+    }
+
+    /**
+     * @brief Check the static validator, then the validator if one is set.
+     * @param value The value to validate.
+     * @return true if the value is valid, false otherwise.
+     */
+    bool Validate(T& value)
+    {
+        if (!typename Policy::StaticValidator{}(value))
+            return false;
+        if constexpr (Policy::DynamicValidation)
+            return !m_observers || !m_observers->m_validator || m_observers->m_validator(value);
+        else
+            return true;
+    }
+
+    /**
+     * @brief Notify all registered callbacks of a change.
+     *
+     * With a reentrant lock policy, runs the callback snapshot rather than the
+     * registry, since callbacks may then add or remove callbacks mid-iteration.
+     *
+     * @param oldValue The old value before the change.
+     * @param newValue The new value after the change.
+     */
+    void NotifyCallbacks(T& oldValue, T& newValue)
+    {
+        if (Policy::Lock::Reentrant || m_observers->dispatcher)
+            return DispatchCallbacks(m_observers->dispatcher.get(), this->StatsHandle(), CallbackSnapshot(), oldValue, newValue);
+        m_observers->callbacks.ForEachWithID([&](CallbackID id, const ChangeCallback& callback)
+        {
+            if (callback)
+                Instrumentation::Run(this->StatsHandle(), id, callback, oldValue, newValue); // Call each registered callback.
+        });
+    }
+
+    /**
+     * @brief Run a snapshot of the callbacks, or post it to a dispatcher.
+     *
+     * When posted, the task owns the snapshot and copies of the values, so it
+     * stays valid even if the property is destroyed before it runs.
+     *
+     * @param dispatcher The executor to post to, or nullptr to run the callbacks now.
+     * @param stats Where callback execution times are recorded, when instrumented.
+     * @param callbacks The callbacks to run.
+     * @param oldValue The old value before the change; moved into the task when posted.
+     * @param newValue The new value after the change.
+     */
+    static void DispatchCallbacks(PropertyDispatcher* dispatcher, const InstrumentationHandle& stats, CallbackList callbacks, T& oldValue, T& newValue)
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        if (m_callbacks.erase(id)) // Remove the callback if it exists.
+        if (callbacks->empty())
+            return;
+        if (!dispatcher)
         {
-            m_availableIDs.push(id); // Add the ID to the available IDs queue.
+            for (const auto& [id, callback] : *callbacks)
+                if (callback)
+                    Instrumentation::Run(stats, id, callback, oldValue, newValue); // Call each registered callback.
+            return;
         }
+        dispatcher->Post([stats, callbacks = std::move(callbacks), oldValue = std::move(oldValue), newValue = newValue]() mutable
+        {
+            for (const auto& [id, callback] : *callbacks)
+                if (callback)
+                    Instrumentation::Run(stats, id, callback, oldValue, newValue); // Call each registered callback.
+        });
     }
 
     /**
-     * @brief Add a one-way binding to another property.
-     * @param other The other property to bind to.
+     * @brief Take a new value from a property this one is bound to.
+     *
+     * Fires this property's callbacks; its own bindings are left to `BindingGraph`.
+     * Changes older than the value already held are dropped.
+     *
+     * @param newValue The new value of the source property, moved from if it is an rvalue.
+     * @param stamp The stamp of the write being propagated.
+     * @return true if the value was changed, false otherwise.
      */
-    void AddOneWayBind(Property<T>& other)
+    template<typename V>
+    bool ReceiveBinding(V&& newValue, uint64_t stamp)
     {
-        m_bindings.insert(&other); // Add to bindings.
+        Observers& observers = *m_observers; // Allocated before the binding was added, never released.
+        if (stamp <= observers.stamp.load(memory_order_relaxed))
+            return false; // Stale, skip the lock.
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        if (stamp <= observers.stamp.load(memory_order_relaxed))
+            return false; // A newer write won the race.
+        observers.stamp.store(stamp, memory_order_relaxed);
+        if (Differs(newValue))
+        {
+            T value = std::forward<V>(newValue); // Coerce a copy so the source value stays intact.
+            Coerce(value); // Apply coercion if specified.
+            if (!Differs(value))
+                return false; // Coerced onto the current value.
+            if (Validate(value))
+            {
+                Commit(lock, std::move(value), false); // Update bound property value.
+                return true;
+            }
+            this->RecordRejected();
+        }
+        return false;
     }
 
     /**
-     * @brief Remove a one-way binding to another property.
-     * @param other The other property to unbind.
+     * @brief Push the value of a property into a property bound to it.
+     * @param source The property the value comes from.
+     * @param target The property the value goes to.
+     * @param sourceValue The new value of `source`, or nullptr to read it.
+     * @param stamp The stamp of the write being propagated.
+     * @return true if the target changed.
      */
-    void RemoveOneWayBind(Property<T>& other)
+    static bool ApplyBinding(BindingNode& source, BindingNode& target, const void* sourceValue, uint64_t stamp, const void*)
     {
-        m_bindings.erase(&other); // Remove from bindings.
+        Property& to = static_cast<Property&>(target);
+        if (sourceValue)
+            return to.ReceiveBinding(*static_cast<const T*>(sourceValue), stamp);
+        return to.ReceiveBinding(static_cast<Property&>(source).Get(), stamp);
     }
 
     /**
-     * @brief Add a one-way-to-source binding to another property.
-     * @param other The other property to bind with this property.
+     * @brief Convert the value of a property and push it into a property of another type bound to it.
+     * @param source The property the value comes from.
+     * @param target The `Property<U, Q>` the converted value goes to.
+     * @param sourceValue The new value of `source`, or nullptr to read it.
+     * @param stamp The stamp of the write being propagated.
+     * @param context The `Converter`.
+     * @return true if the target changed.
      */
-    void AddOneWayToSourceBind(Property<T>& other)
+    template<typename U, typename Q, typename Converter>
+    static bool ApplyConvertedBinding(BindingNode& source, BindingNode& target, const void* sourceValue, uint64_t stamp, const void* context)
     {
-        other.AddOneWayBind(*this); // Add this property to the other property's bindings.
+        Property<U, Q>& to = static_cast<Property<U, Q>&>(target);
+        const Converter& converter = *static_cast<const Converter*>(context);
+        if (sourceValue)
+            return to.ReceiveBinding(static_cast<U>(converter(*static_cast<const T*>(sourceValue))), stamp);
+        return to.ReceiveBinding(static_cast<U>(converter(static_cast<Property&>(source).Get())), stamp);
     }
 
     /**
-     * @brief Remove a one-way-to-source binding from another property.
-     * @param other The other property to unbind from this property.
+     * @brief Append the bindings of a property, copied under its lock.
+     * @param node The property.
+     * @param out The vector the outgoing edges are appended to.
      */
-    void RemoveOneWayToSourceBind(Property<T>& other)
+    static void BindingEdges(const BindingNode& node, vector<Edge>& out)
     {
-        other.RemoveOneWayBind(*this); // Remove this property from the other property's bindings.
+        const Property& property = static_cast<const Property&>(node);
+        typename Policy::Lock::ReadGuard lock(property.GetMutex()); // Ensure thread-safety.
+        if (property.m_observers)
+            out.insert(out.end(), property.m_observers->bindings.begin(), property.m_observers->bindings.end());
     }
 
+#ifdef PROPERTY_COROUTINES
     /**
-     * @brief Add a two-way binding with another property.
-     * @param other The other property to bind with.
+     * @brief Start waiting for a value, unless the current one is accepted. Used by `PropertyChangeAwaiter`.
+     * @param waiter The waiter.
+     * @param checkCurrent Whether to offer the current value first.
+     * @return true if the waiter was listed, false if the current value was accepted.
      */
-    void AddBind(Property<T>& other)
+    bool AddWaiter(PropertyInternals::Waiter<T>& waiter, bool checkCurrent)
     {
-        AddOneWayBind(other); // Add one-way binding to the other property.
-        AddOneWayToSourceBind(other); // Add one-way-to-source binding with the other property.
+        lock_guard<Mutex> lock(GetMutex()); // Changes are notified under the lock or after it, never missed.
+        if (checkCurrent && m_storage.Visit([&](const T& value) { return waiter.Offer(value); }))
+            return false;
+        Observers& observers = GetObservers();
+        if (!observers.waiters)
+        {
+            observers.waiters = allocate_shared<PropertyInternals::WaitList<T>>(this->GetAllocator());
+            observers.callbackSnapshot.reset(); // The snapshot is rebuilt on the next change.
+            observers.callbacks.Add([waiters = observers.waiters](T&, T& newValue) { waiters->Notify(newValue); });
+        }
+        observers.waiters->Add(waiter); // The waiter may be woken and destroyed from here on.
+        return true;
     }
+#endif
 
     /**
-     * @brief Remove a two-way binding with another property.
-     * @param other The other property to unbind.
+     * @brief Copy the value into raw memory. Used by `PropertyArchive`.
+     * @param out Where to copy the `sizeof(T)` bytes of the value to.
      */
-    void RemoveBind(Property<T>& other)
+    void SaveBytes(void* out) const
     {
-        RemoveOneWayBind(other); // Remove one-way binding to the other property.
-        RemoveOneWayToSourceBind(other); // Remove one-way-to-source binding with the other property.
+        typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+        m_storage.Visit([&](const T& value) { memcpy(out, addressof(value), sizeof(T)); });
     }
 
     /**
-     * @brief Set the validator function for new values.
-     * @param validator The validator function.
+     * @brief Replace the value from raw memory without coercion, validation or notification. Used by `PropertyArchive`.
+     * @param in Where the `sizeof(T)` bytes of the new value are.
+     * @param oldOut Where to copy the bytes of the old value to if it changed, or nullptr.
+     * @return true if the value was changed, false otherwise.
      */
-    void SetValidator(Validator validator)
+    bool RestoreBytes(const void* in, void* oldOut)
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        m_validator = validator; // Set the validator function.
+        T newValue = PropertyInternals::FromBytes<T>(in);
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        if (!m_storage.Visit([&](const T& value) { return typename Policy::Comparator{}(value, newValue); }))
+            return false;
+        if (oldOut)
+        {
+            const T oldValue = m_storage.Exchange(std::move(newValue));
+            memcpy(oldOut, addressof(oldValue), sizeof(T));
+        }
+        else
+        {
+            m_storage.Store(std::move(newValue));
+        }
+        BumpVersion();
+        this->RecordChange();
+        return true;
     }
 
     /**
-     * @brief Set the coercion callback function for new values.
-     * @param coerceCallback The coercion callback function.
+     * @brief Notify a change made by `RestoreBytes`. Used by `PropertyArchive`.
+     * @param oldBytes The bytes of the value before the restore.
      */
-    void SetCoerceCallback(CoerceCallback coerceCallback)
+    void NotifyRestored(const void* oldBytes)
     {
-        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
-        m_coerceCallback = coerceCallback; // Set the coercion callback function.
+        unique_lock<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        Observers* observers = m_observers.get();
+        if (!observers || (observers->callbacks.Empty() && observers->bindings.empty()))
+            return; // Nobody to tell.
+        T oldValue = PropertyInternals::FromBytes<T>(oldBytes);
+        if (observers->anchor)
+            observers->stamp.store(BindingGraph::NextStamp(), memory_order_relaxed); // Restoring counts as a local write.
+        if (observers->updateDepth > 0)
+        {
+            if (!observers->pendingOldValue)
+                observers->pendingOldValue = std::move(oldValue); // Notified in EndUpdate.
+            return;
+        }
+        T newValue = m_storage.Load();
+        if (typename Policy::Comparator{}(oldValue, newValue))
+            Notify(lock, oldValue, newValue); // Notify callbacks and bound properties.
     }
 
-private:
     /**
-     * @brief Notify all registered callbacks of a change.
-     * @param oldValue The old value before the change.
-     * @param newValue The new value after the change.
+     * @brief Coerce and validate a value without storing it. Used by `SharedProperty`.
+     * @param value The value to coerce and validate.
+     * @return true if the value is valid, false otherwise.
      */
-    void NotifyCallbacks(T& oldValue, T& newValue)
+    bool Admit(T& value)
     {
-        for (const auto& callbackPair : m_callbacks)
-            if (const auto& callback = callbackPair.second)
-                callback(oldValue, newValue); // Call each registered callback.
+        unique_lock<Mutex> lock = this->LockForWrite(GetMutex()); // Ensure thread-safety.
+        this->RecordWrite();
+        Coerce(value); // Apply coercion if specified.
+        if (Validate(value)) // Validate if validator is provided.
+            return true;
+        this->RecordRejected();
+        return false;
     }
 
     /**
-     * @brief Notify all bound properties of a change.
-     * @param oldValue The old value before the change.
-     * @param newValue The new value after the change.
+     * @brief Get the immutable snapshot of the callbacks, building it if needed.
+     *
+     * Must be called with the lock held. Copying the returned pointer is all a
+     * notification needs to keep the callbacks alive after the lock is released.
+     *
+     * @return The shared callback list.
      */
-    void NotifyBindings(T& oldValue, T& newValue)
+    CallbackList CallbackSnapshot()
     {
-        for (Property<T>* binding : m_bindings)
+        CallbackList& snapshot = m_observers->callbackSnapshot;
+        if (!snapshot)
         {
-            lock_guard<mutex> lock(binding->m_mutex); // Ensure thread-safety.
-            if (binding->m_value != newValue)
-            {
-                if (binding->m_coerceCallback)
-                    binding->m_coerceCallback(newValue); // Apply coercion if specified.
-                if (!binding->m_validator || binding->m_validator(newValue))
-                    binding->m_value = newValue; // Update bound property value.
-            }
+            CallbackVector callbacks(this->GetAllocator());
+            callbacks.reserve(m_observers->callbacks.Size());
+            m_observers->callbacks.ForEachWithID([&](CallbackID id, const ChangeCallback& callback) { callbacks.emplace_back(id, callback); });
+            snapshot = allocate_shared<CallbackVector>(this->GetAllocator(), std::move(callbacks)); // Moves the buffer, no copy.
         }
+        return snapshot;
+    }
+};
+
+
+/**
+ * @brief Property whose validator and coercer are template parameters.
+ *
+ * Example: `StaticProperty<int, AcceptAll, Clamp<0, 100>> percent(50);`
+ */
+template<typename T, typename Validator = AcceptAll, typename Coercer = NoCoercion>
+using StaticProperty = Property<T, StaticPropertyPolicy<T, Validator, Coercer>>;
+
+/**
+ * @brief Scope coalescing the changes of several properties.
+ *
+ * Calls `BeginUpdate` on every added property and `EndUpdate` on each of them,
+ * in the order they were added, when the batch is destroyed. Properties may
+ * have different value types.
+ */
+struct PropertyBatch
+{
+    /**
+     * @brief Start a batch over the given properties.
+     * @param properties The properties to batch.
+     */
+    template<typename... Properties>
+    explicit PropertyBatch(Properties&... properties)
+    {
+        m_endUpdates.reserve(sizeof...(Properties));
+        (Add(properties), ...);
+    }
+
+    PropertyBatch(const PropertyBatch&) = delete;
+    PropertyBatch& operator=(const PropertyBatch&) = delete;
+
+    ~PropertyBatch()
+    {
+        for (const auto& endUpdate : m_endUpdates)
+            endUpdate();
+    }
+
+    /**
+     * @brief Add a property to the batch.
+     * @param property The property to batch.
+     */
+    template<typename Property>
+    void Add(Property& property)
+    {
+        property.BeginUpdate();
+        m_endUpdates.push_back([&property] { property.EndUpdate(); });
     }
+
+private:
+    vector<function<void()>> m_endUpdates; /// Ends the update of each batched property.
 };
@@ -0,0 +1,301 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "property.h"
+#include "property_array.h"
+
+using namespace std;
+
+/**
+ * @brief How `PropertyArchive::Restore` tells observers about restored values.
+ */
+enum class RestoreNotification
+{
+    Silent, /// Store the values only; callbacks and bound properties are not told.
+    NotifyOnce, /// Store every value first, then notify each changed property once.
+};
+
+/**
+ * @brief Binary snapshot and restore of a fixed set of properties and property arrays.
+ *
+ * Properties are registered once, in a fixed order; `Save` then copies each
+ * value straight from its storage into one contiguous buffer, and `Restore`
+ * copies them back in bulk. Restoring skips coercion and validation (the values
+ * were valid when saved) and never assigns through `operator=`, so loading does
+ * not run a callback per value or ripple through bindings half-way.
+ *
+ * Values must be trivially copyable. The buffer is raw memory owned by the
+ * caller and may be a memory-mapped file. Its layout is a header followed by
+ * one record per registered object, each 16-byte aligned:
+ *
+ * - header: magic `PRPA`, format version, record count and total size;
+ * - record: element size, payload size, then the payload bytes.
+ *
+ * A snapshot is only restored if the header and every record match the
+ * registered objects exactly; otherwise nothing is changed. The format uses the
+ * host byte order and type layout, so it is meant for state saved and restored
+ * by the same build.
+ *
+ * Registered objects must outlive the archive.
+ */
+struct PropertyArchive
+{
+    /**
+     * @brief Register a property.
+     * @param property The property to save and restore.
+     */
+    template<typename T, typename Policy>
+    void Add(Property<T, Policy>& property)
+    {
+        static_assert(is_trivially_copyable_v<T>, "PropertyArchive only stores trivially copyable values.");
+        Entry entry;
+        entry.target = &property;
+        entry.elementSize = sizeof(T);
+        entry.byteCount = [](const void*) { return sizeof(T); };
+        entry.save = [](const void* target, unsigned char* out, size_t capacity)
+        {
+            if (capacity < sizeof(T))
+                return SIZE_MAX;
+            static_cast<const Property<T, Policy>*>(target)->SaveBytes(out);
+            return sizeof(T);
+        };
+        entry.restore = [](void* target, const unsigned char* in, size_t, unsigned char* old, size_t&, size_t&)
+        {
+            return static_cast<Property<T, Policy>*>(target)->RestoreBytes(in, old);
+        };
+        entry.notify = [](void* target, const unsigned char* old, size_t, size_t)
+        {
+            static_cast<Property<T, Policy>*>(target)->NotifyRestored(old);
+        };
+        m_entries.push_back(entry);
+        m_oldValueBytes += sizeof(T);
+    }
+
+    /**
+     * @brief Register a property array. Restoring requires it to have the size it had when saved.
+     * @param array The array to save and restore.
+     */
+    template<typename T, typename Policy>
+    void Add(PropertyArray<T, Policy>& array)
+    {
+        static_assert(is_trivially_copyable_v<T>, "PropertyArchive only stores trivially copyable values.");
+        Entry entry;
+        entry.target = &array;
+        entry.array = true;
+        entry.elementSize = sizeof(T);
+        entry.byteCount = [](const void* target) { return static_cast<const PropertyArray<T, Policy>*>(target)->Size() * sizeof(T); };
+        entry.save = [](const void* target, unsigned char* out, size_t capacity)
+        {
+            return static_cast<const PropertyArray<T, Policy>*>(target)->SaveBytes(out, capacity);
+        };
+        entry.restore = [](void* target, const unsigned char* in, size_t bytes, unsigned char*, size_t& first, size_t& last)
+        {
+            return static_cast<PropertyArray<T, Policy>*>(target)->RestoreBytes(in, bytes, first, last);
+        };
+        entry.notify = [](void* target, const unsigned char*, size_t first, size_t last)
+        {
+            static_cast<PropertyArray<T, Policy>*>(target)->NotifyRestored(first, last);
+        };
+        m_entries.push_back(entry);
+    }
+
+    /**
+     * @brief Get the number of registered objects.
+     */
+    size_t Count() const
+    {
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Get the number of bytes `Save` needs for the current values.
+     */
+    size_t SnapshotSize() const
+    {
+        size_t size = HeaderSize;
+        for (const Entry& entry : m_entries)
+            size += sizeof(Record) + Padded(entry.byteCount(entry.target));
+        return size;
+    }
+
+    /**
+     * @brief Copy every registered value into a buffer.
+     *
+     * Each object is read under its own lock, so the snapshot is consistent per
+     * object but not across objects written concurrently.
+     *
+     * @param buffer Where to write the snapshot, aligned to 16 bytes for the fastest restore.
+     * @param capacity The number of bytes available at `buffer`; at least `SnapshotSize()`.
+     * @return The number of bytes written, or 0 if the buffer was too small.
+     */
+    size_t Save(void* buffer, size_t capacity) const
+    {
+        if (capacity < HeaderSize)
+            return 0;
+        unsigned char* out = static_cast<unsigned char*>(buffer);
+        memset(out, 0, HeaderSize);
+        size_t offset = HeaderSize;
+        for (const Entry& entry : m_entries)
+        {
+            if (capacity - offset < sizeof(Record))
+                return 0;
+            const size_t bytes = entry.save(entry.target, out + offset + sizeof(Record), capacity - offset - sizeof(Record));
+            if (bytes == SIZE_MAX || capacity - offset - sizeof(Record) < Padded(bytes))
+                return 0; // Grew since SnapshotSize was called.
+            const Record record{ entry.elementSize, bytes };
+            memcpy(out + offset, &record, sizeof(Record));
+            memset(out + offset + sizeof(Record) + bytes, 0, Padded(bytes) - bytes); // Keep the padding deterministic.
+            offset += sizeof(Record) + Padded(bytes);
+        }
+        const Header header{ Magic, FormatVersion, 0, uint32_t(m_entries.size()), offset };
+        memcpy(out, &header, sizeof(Header));
+        return offset;
+    }
+
+    /**
+     * @brief Copy every registered value into a new buffer.
+     * @return The snapshot.
+     */
+    vector<unsigned char> Save() const
+    {
+        vector<unsigned char> buffer;
+        do
+        {
+            buffer.resize(SnapshotSize());
+        }
+        while (Save(buffer.data(), buffer.size()) == 0); // Retry if an array grew in between.
+        return buffer;
+    }
+
+    /**
+     * @brief Restore every registered value from a snapshot.
+     *
+     * The whole snapshot is checked before any value is touched. Values are
+     * stored without coercion or validation. With `NotifyOnce`, every value is
+     * stored before the first callback runs, then each changed property notifies
+     * once and propagates to its bindings; arrays report the range that changed.
+     *
+     * @param buffer The snapshot written by `Save`.
+     * @param size The number of bytes at `buffer`.
+     * @param notification Whether to notify observers afterwards.
+     * @return false if the snapshot does not match the registered objects.
+     */
+    bool Restore(const void* buffer, size_t size, RestoreNotification notification = RestoreNotification::NotifyOnce)
+    {
+        const unsigned char* in = static_cast<const unsigned char*>(buffer);
+        Header header;
+        if (size < HeaderSize)
+            return false;
+        memcpy(&header, in, sizeof(Header));
+        if (header.magic != Magic || header.version != FormatVersion || header.count != m_entries.size() ||
+            header.size < HeaderSize || header.size > size)
+            return false;
+        vector<size_t> offsets(m_entries.size());
+        size_t offset = HeaderSize;
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            Record record;
+            if (header.size - offset < sizeof(Record))
+                return false;
+            memcpy(&record, in + offset, sizeof(Record));
+            const Entry& entry = m_entries[i];
+            if (record.elementSize != entry.elementSize || record.byteCount != entry.byteCount(entry.target) ||
+                header.size - offset - sizeof(Record) < Padded(record.byteCount))
+                return false;
+            offsets[i] = offset;
+            offset += sizeof(Record) + Padded(record.byteCount);
+        }
+        const bool notify = notification == RestoreNotification::NotifyOnce;
+        vector<unsigned char> oldValues(notify ? m_oldValueBytes : 0); // Old values of changed properties.
+        vector<Pending> pending;
+        size_t oldOffset = 0;
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            const Entry& entry = m_entries[i];
+            Record record;
+            memcpy(&record, in + offsets[i], sizeof(Record));
+            unsigned char* old = notify && !entry.array ? oldValues.data() + oldOffset : nullptr;
+            Pending change{ i, old, 0, 0 };
+            if (entry.restore(entry.target, in + offsets[i] + sizeof(Record), size_t(record.byteCount), old, change.first, change.last) && notify)
+                pending.push_back(change);
+            if (!entry.array)
+                oldOffset += entry.elementSize;
+        }
+        for (const Pending& change : pending)
+            m_entries[change.index].notify(m_entries[change.index].target, change.old, change.first, change.last);
+        return true;
+    }
+
+private:
+    struct Header
+    {
+        uint32_t magic; /// Always `Magic`.
+        uint16_t version; /// Always `FormatVersion`.
+        uint16_t reserved; /// Zero.
+        uint32_t count; /// Number of records.
+        uint64_t size; /// Total size in bytes, header included.
+    };
+
+    struct Record
+    {
+        uint64_t elementSize; /// `sizeof` the value type.
+        uint64_t byteCount; /// Size of the payload, without padding.
+    };
+
+    struct Entry
+    {
+        void* target = nullptr; /// The property or array.
+        bool array = false; /// Whether `target` is a `PropertyArray`.
+        size_t elementSize = 0; /// `sizeof` its value type.
+        size_t (*byteCount)(const void* target) = nullptr; /// Size of its payload.
+        size_t (*save)(const void* target, unsigned char* out, size_t capacity) = nullptr; /// Copies its values out.
+        bool (*restore)(void* target, const unsigned char* in, size_t bytes, unsigned char* old, size_t& first, size_t& last) = nullptr; /// Stores its values silently.
+        void (*notify)(void* target, const unsigned char* old, size_t first, size_t last) = nullptr; /// Notifies a restored change.
+    };
+
+    struct Pending
+    {
+        size_t index; /// The changed entry.
+        unsigned char* old; /// Its old value, for properties.
+        size_t first; /// First changed element, for arrays.
+        size_t last; /// One past the last changed element, for arrays.
+    };
+
+    static constexpr uint32_t Magic = 0x41505250; /// "PRPA" in little-endian byte order.
+    static constexpr uint16_t FormatVersion = 1;
+    static constexpr size_t HeaderSize = (sizeof(Header) + 15) & ~size_t(15); /// Keeps the records 16-byte aligned.
+
+    static size_t Padded(size_t bytes)
+    {
+        return (bytes + 15) & ~size_t(15);
+    }
+
+    vector<Entry> m_entries; /// Registered objects, in snapshot order.
+    size_t m_oldValueBytes = 0; /// Total value size of the registered properties.
+};
@@ -0,0 +1,516 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include "property.h"
+
+using namespace std;
+
+/**
+ * @brief Contiguous array of property values sharing one lock and one set of observers.
+ *
+ * Where thousands of entities each carry the same field, one `PropertyArray`
+ * per field stores the values of all entities side by side (struct of arrays)
+ * instead of scattering a `Property` per entity across the heap. Callbacks are
+ * registered once for the whole array and are told which range changed, and
+ * bulk writes notify once per call.
+ *
+ * Coercion and validation (static and runtime) apply to each element like they
+ * do for `Property`. Callbacks run while the lock is held and must not write to
+ * the array.
+ */
+template<typename T, typename Policy = PropertyPolicy<T>>
+struct PropertyArray : private Policy::Lock
+{
+public:
+    /**
+     * @brief Type definition for range change callback function.
+     *
+     * The function signature should be:
+     * void callback(size_t first, size_t count, const T* values);
+     *
+     * @param first The index of the first changed element.
+     * @param count The number of elements in the changed range.
+     * @param values The current values of the range, valid during the call only.
+     */
+    using ChangeCallback = typename Policy::template Function<void(size_t first, size_t count, const T* values)>;
+
+    /**
+     * @brief Type definition for value validator function, applied to each element.
+     */
+    using Validator = typename Policy::template Function<bool(T& newValue)>;
+
+    /**
+     * @brief Type definition for coercion callback function, applied to each element.
+     */
+    using CoerceCallback = typename Policy::template Function<void(T& newValue)>;
+
+    /**
+     * @brief Type definition for callback IDs.
+     */
+    using CallbackID = typename CallbackRegistry<ChangeCallback>::ID;
+
+private:
+    friend struct PropertyArchive;
+
+    using DynamicValidation = PropertyInternals::DynamicValidation<Validator, CoerceCallback, Policy::DynamicValidation>;
+    using Mutex = typename Policy::Lock::Mutex;
+
+    /// Values coerced per chunk of a bulk write: a kilobyte of plain data, else one at a time so only one `T` is default-constructed.
+    static constexpr size_t ScratchSize = is_trivially_copyable_v<T> ? max<size_t>(1, 1024 / sizeof(T)) : 1;
+
+public:
+    /**
+     * @brief Constructor.
+     * @param size The number of elements.
+     * @param value The initial value of every element.
+     */
+    explicit PropertyArray(size_t size = 0, const T& value = T())
+        : m_values(new T[size]), m_size(size)
+    {
+        fill(m_values.get(), m_values.get() + size, value);
+    }
+
+    PropertyArray(const PropertyArray&) = delete;
+    PropertyArray& operator=(const PropertyArray&) = delete;
+
+    /**
+     * @brief Get the number of elements.
+     */
+    size_t Size() const
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        return m_size;
+    }
+
+    /**
+     * @brief Change the number of elements. Does not notify.
+     * @param size The new number of elements.
+     * @param value The value of the added elements.
+     */
+    void Resize(size_t size, const T& value = T())
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        unique_ptr<T[]> values(new T[size]);
+        const size_t kept = min(size, m_size);
+        move(m_values.get(), m_values.get() + kept, values.get());
+        fill(values.get() + kept, values.get() + size, value);
+        m_values = std::move(values);
+        m_size = size;
+    }
+
+    /**
+     * @brief Get the value of one element.
+     * @param index The element.
+     * @return A copy of its value.
+     */
+    T Get(size_t index) const
+    {
+        typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+        return m_values[index];
+    }
+
+    /**
+     * @brief Copy a range of values out.
+     * @param first The index of the first element.
+     * @param out Where to copy `count` values to.
+     * @param count The number of elements.
+     */
+    void Get(size_t first, T* out, size_t count) const
+    {
+        typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+        copy(m_values.get() + first, m_values.get() + first + count, out);
+    }
+
+    /**
+     * @brief Scan every value without copying it.
+     *
+     * The lock is held during the call, so `reader` must not write to the array.
+     *
+     * @param reader Called as `reader(const T* values, size_t size)`.
+     * @return Whatever `reader` returns.
+     */
+    template<typename Reader>
+    decltype(auto) Read(Reader&& reader) const
+    {
+        typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+        return reader(static_cast<const T*>(m_values.get()), m_size);
+    }
+
+    /**
+     * @brief Set the value of one element.
+     * @param index The element, less than `Size()`.
+     * @param newValue The new value.
+     * @return true if the value was changed, false otherwise.
+     */
+    bool Set(size_t index, T newValue)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        assert(index < m_size);
+        Coerce(newValue); // Apply coercion if specified.
+        T& element = m_values[index];
+        if (!typename Policy::Comparator{}(element, newValue) || !Validate(newValue))
+            return false;
+        element = std::move(newValue);
+        Changed(index, index + 1);
+        return true;
+    }
+
+    /**
+     * @brief Set a range of values, notifying once.
+     *
+     * The static coercer and validator of the policy process the whole range at
+     * once when they have span overloads (`Clamp`, `InRange` and `Finite` use
+     * vector instructions for arithmetic types); the runtime coerce callback and
+     * validator then run per value. Rejected and unchanged values leave their
+     * element untouched. The callbacks are told the smallest range covering
+     * every changed element. Values are coerced in chunks copied to the stack,
+     * so no call allocates.
+     *
+     * @param first The index of the first element.
+     * @param values The `count` new values.
+     * @param count The number of elements; `first + count` must be at most `Size()`.
+     * @return The number of elements that changed.
+     */
+    size_t Set(size_t first, const T* values, size_t count)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        assert(first <= m_size && count <= m_size - first);
+        T scratch[ScratchSize];
+        size_t changed = 0, low = m_size, high = 0;
+        for (size_t done = 0; done < count; done += ScratchSize)
+        {
+            const size_t chunk = min(ScratchSize, count - done);
+            copy(values + done, values + done + chunk, scratch);
+            changed += StoreChunk(first + done, scratch, chunk, low, high);
+        }
+        if (changed)
+            Changed(low, high);
+        return changed;
+    }
+
+    /**
+     * @brief Set a range of elements to the same value, notifying once.
+     * @param first The index of the first element.
+     * @param count The number of elements; `first + count` must be at most `Size()`.
+     * @param newValue The new value.
+     * @return The number of elements that changed.
+     */
+    size_t Fill(size_t first, size_t count, T newValue)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        assert(first <= m_size && count <= m_size - first);
+        Coerce(newValue); // Apply coercion if specified.
+        if (!Validate(newValue))
+            return 0;
+        size_t changed = 0, low = m_size, high = 0;
+        for (size_t i = first; i < first + count; ++i)
+        {
+            if (!typename Policy::Comparator{}(m_values[i], newValue))
+                continue;
+            m_values[i] = newValue;
+            ++changed;
+            low = min(low, i);
+            high = i + 1;
+        }
+        if (changed)
+            Changed(low, high);
+        return changed;
+    }
+
+    /**
+     * @brief Start coalescing changes.
+     *
+     * Until the matching `EndUpdate`, writes are stored but not notified.
+     * Calls nest; only the outermost `EndUpdate` notifies, once, with the
+     * range covering every change of the batch.
+     */
+    void BeginUpdate()
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        ++m_updateDepth;
+    }
+
+    /**
+     * @brief Stop coalescing changes.
+     */
+    void EndUpdate()
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (m_updateDepth == 0 || --m_updateDepth > 0 || m_pendingFirst >= m_pendingLast)
+            return;
+        const size_t first = m_pendingFirst, last = min(m_pendingLast, m_size);
+        m_pendingFirst = m_pendingLast = 0;
+        if (first < last)
+            NotifyCallbacks(first, last);
+    }
+
+    /**
+     * @brief Add a change callback for the whole array and return its ID.
+     * @param callback The callback function to add.
+     * @return The ID of the added callback.
+     */
+    CallbackID AddChangeCallback(ChangeCallback callback)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        return m_callbacks.Add(std::move(callback)); // Store the callback and return its ID.
+    }
+
+    /**
+     * @brief Remove a change callback using its ID.
+     * @param id The ID of the callback to remove.
+     */
+    void RemoveChangeCallback(CallbackID id)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        m_callbacks.Remove(id); // Remove the callback if it still exists.
+    }
+
+    /**
+     * @brief Set the validator applied to each new value.
+     * @param validator The validator function.
+     */
+    void SetValidator(Validator validator)
+    {
+        static_assert(Policy::DynamicValidation, "This array does not accept a runtime validator.");
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        m_validation.m_validator = validator; // Set the validator function.
+    }
+
+    /**
+     * @brief Set the coercion callback applied to each new value.
+     * @param coerceCallback The coercion callback function.
+     */
+    void SetCoerceCallback(CoerceCallback coerceCallback)
+    {
+        static_assert(Policy::DynamicValidation, "This array does not accept a runtime coerce callback.");
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        m_validation.m_coerceCallback = coerceCallback; // Set the coercion callback function.
+    }
+
+private:
+    /**
+     * @brief Get the mutex guarding this array from the lock policy.
+     */
+    Mutex& GetMutex() const
+    {
+        return Policy::Lock::GetMutex(this);
+    }
+
+    /**
+     * @brief Copy every value into raw memory. Used by `PropertyArchive`.
+     * @param out Where to copy the values to.
+     * @param capacity The number of bytes available at `out`.
+     * @return The number of bytes copied, or `SIZE_MAX` if they did not fit.
+     */
+    size_t SaveBytes(void* out, size_t capacity) const
+    {
+        typename Policy::Lock::ReadGuard lock(GetMutex()); // Ensure thread-safety.
+        const size_t bytes = m_size * sizeof(T);
+        if (bytes > capacity)
+            return SIZE_MAX;
+        if (bytes)
+            memcpy(out, m_values.get(), bytes);
+        return bytes;
+    }
+
+    /**
+     * @brief Replace every value from raw memory without coercion, validation or notification. Used by `PropertyArchive`.
+     * @param in Where the new values are.
+     * @param bytes The number of bytes at `in`; must match the current size.
+     * @param first Set to the index of the first changed element.
+     * @param last Set to one past the index of the last changed element.
+     * @return true if any value was changed, false otherwise or if the size did not match.
+     */
+    bool RestoreBytes(const void* in, size_t bytes, size_t& first, size_t& last)
+    {
+        static_assert(is_trivially_copyable_v<T>, "Only trivially copyable values can be restored from raw memory.");
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        if (bytes != m_size * sizeof(T))
+            return false; // Resized since the snapshot was checked.
+        const unsigned char* source = static_cast<const unsigned char*>(in);
+        first = m_size;
+        last = 0;
+        for (size_t i = 0; i < m_size; ++i)
+        {
+            const T value = PropertyInternals::FromBytes<T>(source + i * sizeof(T));
+            if (!typename Policy::Comparator{}(m_values[i], value))
+                continue;
+            m_values[i] = value;
+            first = min(first, i);
+            last = i + 1;
+        }
+        return first < last;
+    }
+
+    /**
+     * @brief Notify a range changed by `RestoreBytes`. Used by `PropertyArchive`.
+     * @param first The index of the first changed element.
+     * @param last One past the index of the last changed element.
+     */
+    void NotifyRestored(size_t first, size_t last)
+    {
+        lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+        last = min(last, m_size);
+        if (first < last)
+            Changed(first, last);
+    }
+
+    /**
+     * @brief Apply the static coercer, then the coerce callback if one is set.
+     * @param value The value to coerce.
+     */
+    void Coerce(T& value)
+    {
+        typename Policy::StaticCoercer{}(value);
+        if constexpr (Policy::DynamicValidation)
+            if (m_validation.m_coerceCallback)
+                m_validation.m_coerceCallback(value);
+    }
+
+    /**
+     * @brief Coerce a chunk of new values in place and store the changed, valid ones. Must be called with the lock held.
+     * @param first The index of the element receiving `values[0]`.
+     * @param values The new values, consumed.
+     * @param count The number of values.
+     * @param low Lowered to the first changed index.
+     * @param high Raised to one past the last changed index.
+     * @return The number of elements that changed.
+     */
+    size_t StoreChunk(size_t first, T* values, size_t count, size_t& low, size_t& high)
+    {
+        PropertyInternals::CoerceSpan<typename Policy::StaticCoercer>(values, count);
+        if constexpr (Policy::DynamicValidation)
+            if (m_validation.m_coerceCallback)
+                for (size_t i = 0; i < count; ++i)
+                    m_validation.m_coerceCallback(values[i]); // Apply coercion if specified.
+        size_t changed = 0;
+        for (size_t i = 0; i < count;)
+        {
+            const size_t invalid = i + PropertyInternals::FindInvalid<typename Policy::StaticValidator>(values + i, count - i);
+            for (; i < invalid; ++i)
+            {
+                T& element = m_values[first + i];
+                if (!typename Policy::Comparator{}(element, values[i]) || !ValidateDynamic(values[i]))
+                    continue;
+                element = std::move(values[i]);
+                ++changed;
+                low = min(low, first + i);
+                high = first + i + 1;
+            }
+            ++i; // Skip the rejected value.
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Check the static validator, then the validator if one is set.
+     * @param value The value to validate.
+     * @return true if the value is valid, false otherwise.
+     */
+    bool Validate(T& value)
+    {
+        return typename Policy::StaticValidator{}(value) && ValidateDynamic(value);
+    }
+
+    /**
+     * @brief Check the validator if one is set.
+     * @param value The value to validate.
+     * @return true if the value is valid, false otherwise.
+     */
+    bool ValidateDynamic(T& value)
+    {
+        if constexpr (Policy::DynamicValidation)
+            return !m_validation.m_validator || m_validation.m_validator(value);
+        else
+            return true;
+    }
+
+    /**
+     * @brief Notify a changed range now, or record it while batching. Must be called with the lock held.
+     * @param first The index of the first changed element.
+     * @param last One past the index of the last changed element.
+     */
+    void Changed(size_t first, size_t last)
+    {
+        if (m_updateDepth == 0)
+            return NotifyCallbacks(first, last);
+        if (m_pendingFirst >= m_pendingLast)
+        {
+            m_pendingFirst = first;
+            m_pendingLast = last;
+        }
+        else
+        {
+            m_pendingFirst = min(m_pendingFirst, first);
+            m_pendingLast = max(m_pendingLast, last);
+        }
+    }
+
+    /**
+     * @brief Notify all registered callbacks of a changed range.
+     *
+     * With a reentrant lock policy the callbacks are copied first, since they may
+     * then add or remove callbacks mid-iteration.
+     *
+     * @param first The index of the first changed element.
+     * @param last One past the index of the last changed element.
+     */
+    void NotifyCallbacks(size_t first, size_t last)
+    {
+        const T* values = m_values.get() + first;
+        if constexpr (Policy::Lock::Reentrant)
+        {
+            vector<ChangeCallback> callbacks;
+            callbacks.reserve(m_callbacks.Size());
+            m_callbacks.ForEach([&](const ChangeCallback& callback) { callbacks.push_back(callback); });
+            for (const ChangeCallback& callback : callbacks)
+                if (callback)
+                    callback(first, last - first, values); // Call each registered callback.
+        }
+        else
+        {
+            m_callbacks.ForEach([&](const ChangeCallback& callback)
+            {
+                if (callback)
+                    callback(first, last - first, values); // Call each registered callback.
+            });
+        }
+    }
+
+    unique_ptr<T[]> m_values; /// The values, contiguous.
+    size_t m_size; /// The number of elements.
+    CallbackRegistry<ChangeCallback> m_callbacks; /// Registry of change callbacks with their IDs.
+    DynamicValidation m_validation; /// Runtime validator and coerce callback, empty if disabled.
+    size_t m_updateDepth = 0; /// Nesting depth of BeginUpdate calls.
+    size_t m_pendingFirst = 0; /// First element changed during the current batch.
+    size_t m_pendingLast = 0; /// One past the last element changed during the current batch.
+};
@@ -0,0 +1,712 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "property.h"
+
+using namespace std;
+
+/**
+ * @brief Kind of an edit reported by `PropertyVector` and `PropertyMap`.
+ */
+enum class CollectionChange
+{
+    Insert, /// A value was added.
+    Erase, /// A value was removed.
+    Replace, /// A value was overwritten with a different one.
+};
+
+/**
+ * @brief One edit of a `PropertyVector`. The pointed-to values are valid during the callback only.
+ */
+template<typename T>
+struct VectorChange
+{
+    CollectionChange kind; /// What happened.
+    size_t index; /// The position, after the edits reported before this one have been applied.
+    const T* oldValue; /// The erased or replaced value, null for `Insert`.
+    const T* newValue; /// The inserted or new value, null for `Erase`.
+};
+
+/**
+ * @brief One edit of a `PropertyMap`. The pointed-to values are valid during the callback only.
+ */
+template<typename K, typename V>
+struct MapChange
+{
+    CollectionChange kind; /// What happened.
+    const K* key; /// The key of the entry.
+    const V* oldValue; /// The erased or replaced value, null for `Insert`.
+    const V* newValue; /// The inserted or new value, null for `Erase`.
+};
+
+namespace PropertyInternals
+{
+    /**
+     * @brief Callbacks, validation and batching shared by the observable collections.
+     *
+     * `Change` is the edit type handed to the callbacks and `V` the element or
+     * mapped type the policy validates.
+     */
+    template<typename Change, typename V, typename Policy>
+    struct ObservableCollection : private Policy::Lock
+    {
+        /**
+         * @brief Type definition for change callback function.
+         *
+         * The function signature should be:
+         * void callback(const Change* changes, size_t count);
+         *
+         * @param changes The edits, in the order they were made.
+         * @param count The number of edits, one unless batching.
+         */
+        using ChangeCallback = typename Policy::template Function<void(const Change* changes, size_t count)>;
+
+        /**
+         * @brief Type definition for value validator function, applied to each inserted or new value.
+         */
+        using Validator = typename Policy::template Function<bool(V& newValue)>;
+
+        /**
+         * @brief Type definition for coercion callback function, applied to each inserted or new value.
+         */
+        using CoerceCallback = typename Policy::template Function<void(V& newValue)>;
+
+        /**
+         * @brief Type definition for callback IDs.
+         */
+        using CallbackID = typename CallbackRegistry<ChangeCallback>::ID;
+
+        /**
+         * @brief Add a change callback and return its ID.
+         * @param callback The callback function to add.
+         * @return The ID of the added callback.
+         */
+        CallbackID AddChangeCallback(ChangeCallback callback)
+        {
+            lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+            return m_callbacks.Add(std::move(callback)); // Store the callback and return its ID.
+        }
+
+        /**
+         * @brief Remove a change callback using its ID.
+         * @param id The ID of the callback to remove.
+         */
+        void RemoveChangeCallback(CallbackID id)
+        {
+            lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+            m_callbacks.Remove(id); // Remove the callback if it still exists.
+        }
+
+        /**
+         * @brief Set the validator applied to each inserted or new value.
+         * @param validator The validator function.
+         */
+        void SetValidator(Validator validator)
+        {
+            static_assert(Policy::DynamicValidation, "This collection does not accept a runtime validator.");
+            lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+            m_validation.m_validator = validator; // Set the validator function.
+        }
+
+        /**
+         * @brief Set the coercion callback applied to each inserted or new value.
+         * @param coerceCallback The coercion callback function.
+         */
+        void SetCoerceCallback(CoerceCallback coerceCallback)
+        {
+            static_assert(Policy::DynamicValidation, "This collection does not accept a runtime coerce callback.");
+            lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+            m_validation.m_coerceCallback = coerceCallback; // Set the coercion callback function.
+        }
+
+        /**
+         * @brief Start coalescing changes.
+         *
+         * Until the matching `EndUpdate`, edits are applied and recorded but not
+         * notified. Calls nest; the outermost `EndUpdate` notifies every recorded
+         * edit in one call.
+         */
+        void BeginUpdate()
+        {
+            lock_guard<Mutex> lock(GetMutex()); // Ensure thread-safety.
+            ++m_updateDepth;
+        }
+
+    protected:
+        using Mutex = typename Policy::Lock::Mutex;
+        using DynamicValidation = PropertyInternals::DynamicValidation<Validator, CoerceCallback, Policy::DynamicValidation>;
+
+        ObservableCollection() = default;
+        ObservableCollection(const ObservableCollection&) = delete;
+        ObservableCollection& operator=(const ObservableCollection&) = delete;
+
+        /**
+         * @brief Get the mutex guarding this collection from the lock policy.
+         */
+        Mutex& GetMutex() const
+        {
+            return Policy::Lock::GetMutex(this);
+        }
+
+        /**
+         * @brief Coerce and validate a value about to be stored.
+         * @param value The value.
+         * @return true if the value is valid, false otherwise.
+         */
+        bool Admit(V& value)
+        {
+            Coerce(value);
+            return Validate(value);
+        }
+
+        /**
+         * @brief Apply the static coercer, then the coerce callback if one is set.
+         * @param value The value.
+         */
+        void Coerce(V& value)
+        {
+            typename Policy::StaticCoercer{}(value);
+            if constexpr (Policy::DynamicValidation)
+                if (m_validation.m_coerceCallback)
+                    m_validation.m_coerceCallback(value);
+        }
+
+        /**
+         * @brief Check the static validator, then the validator if one is set.
+         * @param value The value.
+         * @return true if the value is valid, false otherwise.
+         */
+        bool Validate(V& value)
+        {
+            if (!typename Policy::StaticValidator{}(value))
+                return false;
+            if constexpr (Policy::DynamicValidation)
+                return !m_validation.m_validator || m_validation.m_validator(value);
+            else
+                return true;
+        }
+
+        /**
+         * @brief Check whether an edit has to be reported or recorded. Must be called with the lock held.
+         */
+        bool Observed() const
+        {
+            return m_updateDepth > 0 || !m_callbacks.Empty();
+        }
+
+        /**
+         * @brief Leave a batch. Must be called with the lock held.
+         * @return true if this was the outermost batch and the recorded edits are due.
+         */
+        bool LeaveUpdate()
+        {
+            return m_updateDepth > 0 && --m_updateDepth == 0;
+        }
+
+        /**
+         * @brief Notify all registered callbacks of some edits.
+         *
+         * With a reentrant lock policy the callbacks are copied first, since they may
+         * then add or remove callbacks mid-iteration.
+         *
+         * @param changes The edits.
+         * @param count The number of edits.
+         */
+        void NotifyCallbacks(const Change* changes, size_t count)
+        {
+            if (count == 0)
+                return;
+            if constexpr (Policy::Lock::Reentrant)
+            {
+                vector<ChangeCallback> callbacks;
+                callbacks.reserve(m_callbacks.Size());
+                m_callbacks.ForEach([&](const ChangeCallback& callback) { callbacks.push_back(callback); });
+                for (const ChangeCallback& callback : callbacks)
+                    if (callback)
+                        callback(changes, count); // Call each registered callback.
+            }
+            else
+            {
+                m_callbacks.ForEach([&](const ChangeCallback& callback)
+                {
+                    if (callback)
+                        callback(changes, count); // Call each registered callback.
+                });
+            }
+        }
+
+        size_t m_updateDepth = 0; /// Nesting depth of BeginUpdate calls.
+
+    private:
+        CallbackRegistry<ChangeCallback> m_callbacks; /// Registry of change callbacks with their IDs.
+        DynamicValidation m_validation; /// Runtime validator and coerce callback, empty if disabled.
+    };
+}
+
+/**
+ * @brief Observable vector reporting each insert, erase and replace instead of whole copies.
+ *
+ * A `Property<vector<T>>` copies the old vector and compares both on every
+ * write, and its callbacks see two full vectors. `PropertyVector` edits its
+ * elements in place and tells the callbacks what changed, so the cost of a
+ * change scales with the edit rather than with the size of the collection.
+ *
+ * New values are coerced and validated like property values; rejected edits
+ * are not applied. Callbacks run while the lock is held and must not edit the
+ * vector.
+ */
+template<typename T, typename Policy = PropertyPolicy<T>>
+struct PropertyVector : PropertyInternals::ObservableCollection<VectorChange<T>, T, Policy>
+{
+private:
+    using Base = PropertyInternals::ObservableCollection<VectorChange<T>, T, Policy>;
+    using typename Base::Mutex;
+
+public:
+    /**
+     * @brief Type definition for an edit.
+     */
+    using Change = VectorChange<T>;
+
+    PropertyVector() = default;
+
+    /**
+     * @brief Constructor.
+     * @param values The initial elements; not validated.
+     */
+    explicit PropertyVector(vector<T> values) : m_values(std::move(values)) {}
+
+    /**
+     * @brief Get the number of elements.
+     */
+    size_t Size() const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return m_values.size();
+    }
+
+    /**
+     * @brief Get a copy of one element.
+     * @param index The element.
+     */
+    T Get(size_t index) const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return m_values[index];
+    }
+
+    /**
+     * @brief Copy every element out.
+     */
+    vector<T> ToVector() const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return m_values;
+    }
+
+    /**
+     * @brief Scan every element without copying it.
+     *
+     * The lock is held during the call, so `reader` must not edit the vector.
+     *
+     * @param reader Called as `reader(const vector<T>& values)`.
+     * @return Whatever `reader` returns.
+     */
+    template<typename Reader>
+    decltype(auto) Read(Reader&& reader) const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return reader(static_cast<const vector<T>&>(m_values));
+    }
+
+    /**
+     * @brief Append an element.
+     * @param value The new element.
+     * @return true if it was added, false if it was rejected.
+     */
+    bool PushBack(T value)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        return InsertLocked(m_values.size(), std::move(value));
+    }
+
+    /**
+     * @brief Insert an element.
+     * @param index The position, at most `Size()`.
+     * @param value The new element.
+     * @return true if it was added, false if it was rejected.
+     */
+    bool Insert(size_t index, T value)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        return InsertLocked(index, std::move(value));
+    }
+
+    /**
+     * @brief Replace an element.
+     * @param index The element.
+     * @param value The new value.
+     * @return true if the element changed, false if it was equal or the value was rejected.
+     */
+    bool Set(size_t index, T value)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        this->Coerce(value); // Compare the coerced value, as Property does.
+        if (!typename Policy::Comparator{}(m_values[index], value) || !this->Validate(value))
+            return false;
+        if (!this->Observed())
+        {
+            m_values[index] = std::move(value);
+            return true;
+        }
+        T oldValue = std::exchange(m_values[index], std::move(value));
+        Changed(CollectionChange::Replace, index, &oldValue, &m_values[index]);
+        return true;
+    }
+
+    /**
+     * @brief Remove an element.
+     * @param index The element.
+     */
+    void Erase(size_t index)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        EraseLocked(index);
+    }
+
+    /**
+     * @brief Remove the last element, if any.
+     */
+    void PopBack()
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        if (!m_values.empty())
+            EraseLocked(m_values.size() - 1);
+    }
+
+    /**
+     * @brief Remove every element, reported as erasures from the back in one notification.
+     */
+    void Clear()
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        if (!this->Observed())
+            return m_values.clear();
+        ++this->m_updateDepth; // One notification for the whole clear.
+        while (!m_values.empty())
+            EraseLocked(m_values.size() - 1);
+        EndUpdateLocked();
+    }
+
+    /**
+     * @brief Stop coalescing changes.
+     */
+    void EndUpdate()
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        EndUpdateLocked();
+    }
+
+private:
+    struct Pending
+    {
+        CollectionChange kind; /// What happened.
+        size_t index; /// The position.
+        optional<T> oldValue; /// The erased or replaced value.
+        optional<T> newValue; /// The inserted or new value.
+    };
+
+    bool InsertLocked(size_t index, T value)
+    {
+        if (!this->Admit(value))
+            return false;
+        m_values.insert(m_values.begin() + index, std::move(value));
+        if (this->Observed())
+            Changed(CollectionChange::Insert, index, nullptr, &m_values[index]);
+        return true;
+    }
+
+    void EraseLocked(size_t index)
+    {
+        if (!this->Observed())
+        {
+            m_values.erase(m_values.begin() + index);
+            return;
+        }
+        T oldValue = std::move(m_values[index]);
+        m_values.erase(m_values.begin() + index);
+        Changed(CollectionChange::Erase, index, &oldValue, nullptr);
+    }
+
+    /**
+     * @brief Report an edit now, or record it while batching. Must be called with the lock held.
+     * @param kind What happened.
+     * @param position Where it happened.
+     * @param oldValue The erased or replaced value, moved from when recorded; null for inserts.
+     * @param newValue The inserted or new value, null for erasures.
+     */
+    void Changed(CollectionChange kind, size_t position, T* oldValue, const T* newValue)
+    {
+        if (this->m_updateDepth == 0)
+        {
+            const Change change{ kind, position, oldValue, newValue };
+            return this->NotifyCallbacks(&change, 1);
+        }
+        Pending& pending = m_pending.emplace_back(Pending{ kind, position, nullopt, nullopt });
+        if (oldValue)
+            pending.oldValue.emplace(std::move(*oldValue)); // Only ever a value about to be dropped.
+        if (newValue)
+            pending.newValue.emplace(*newValue);
+    }
+
+    void EndUpdateLocked()
+    {
+        if (!this->LeaveUpdate() || m_pending.empty())
+            return;
+        vector<Pending> pending;
+        pending.swap(m_pending);
+        vector<Change> changes;
+        changes.reserve(pending.size());
+        for (const Pending& edit : pending)
+            changes.push_back({ edit.kind, edit.index, edit.oldValue ? &*edit.oldValue : nullptr, edit.newValue ? &*edit.newValue : nullptr });
+        this->NotifyCallbacks(changes.data(), changes.size());
+    }
+
+    vector<T> m_values; /// The elements.
+    vector<Pending> m_pending; /// Edits recorded during the current batch.
+};
+
+/**
+ * @brief Observable hash map reporting each insert, erase and replace instead of whole copies.
+ *
+ * The map counterpart of `PropertyVector`: the policy's coercion, validation
+ * and comparator apply to mapped values. Callbacks run while the lock is held
+ * and must not edit the map.
+ */
+template<typename K, typename V, typename Policy = PropertyPolicy<V>, typename Hash = hash<K>, typename KeyEqual = equal_to<K>>
+struct PropertyMap : PropertyInternals::ObservableCollection<MapChange<K, V>, V, Policy>
+{
+private:
+    using Base = PropertyInternals::ObservableCollection<MapChange<K, V>, V, Policy>;
+    using typename Base::Mutex;
+
+public:
+    /**
+     * @brief Type definition for an edit.
+     */
+    using Change = MapChange<K, V>;
+
+    /**
+     * @brief Type definition for the underlying map.
+     */
+    using Map = unordered_map<K, V, Hash, KeyEqual>;
+
+    PropertyMap() = default;
+
+    /**
+     * @brief Constructor.
+     * @param entries The initial entries; not validated.
+     */
+    explicit PropertyMap(Map entries) : m_entries(std::move(entries)) {}
+
+    /**
+     * @brief Get the number of entries.
+     */
+    size_t Size() const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Check whether a key is present.
+     * @param key The key.
+     */
+    bool Contains(const K& key) const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return m_entries.find(key) != m_entries.end();
+    }
+
+    /**
+     * @brief Get a copy of the value of a key.
+     * @param key The key.
+     * @return The value, or nothing if the key is absent.
+     */
+    optional<V> Get(const K& key) const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        auto found = m_entries.find(key);
+        return found == m_entries.end() ? nullopt : optional<V>(found->second);
+    }
+
+    /**
+     * @brief Scan every entry without copying it.
+     *
+     * The lock is held during the call, so `reader` must not edit the map.
+     *
+     * @param reader Called as `reader(const Map& entries)`.
+     * @return Whatever `reader` returns.
+     */
+    template<typename Reader>
+    decltype(auto) Read(Reader&& reader) const
+    {
+        typename Policy::Lock::ReadGuard lock(this->GetMutex()); // Ensure thread-safety.
+        return reader(static_cast<const Map&>(m_entries));
+    }
+
+    /**
+     * @brief Insert or replace the value of a key.
+     * @param key The key.
+     * @param value The new value.
+     * @return true if the map changed, false if the value was equal or rejected.
+     */
+    bool Set(const K& key, V value)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        auto found = m_entries.find(key);
+        this->Coerce(value); // Compare the coerced value, as Property does.
+        if (found != m_entries.end() && !typename Policy::Comparator{}(found->second, value))
+            return false;
+        if (!this->Validate(value))
+            return false;
+        if (found == m_entries.end())
+        {
+            found = m_entries.emplace(key, std::move(value)).first;
+            if (this->Observed())
+                Changed(CollectionChange::Insert, found->first, nullptr, &found->second);
+            return true;
+        }
+        if (!this->Observed())
+        {
+            found->second = std::move(value);
+            return true;
+        }
+        V oldValue = std::exchange(found->second, std::move(value));
+        Changed(CollectionChange::Replace, found->first, &oldValue, &found->second);
+        return true;
+    }
+
+    /**
+     * @brief Remove a key.
+     * @param key The key.
+     * @return true if it was present.
+     */
+    bool Erase(const K& key)
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        auto found = m_entries.find(key);
+        if (found == m_entries.end())
+            return false;
+        EraseLocked(found);
+        return true;
+    }
+
+    /**
+     * @brief Remove every entry, reported as erasures in one notification.
+     */
+    void Clear()
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        if (!this->Observed())
+            return m_entries.clear();
+        ++this->m_updateDepth; // One notification for the whole clear.
+        while (!m_entries.empty())
+            EraseLocked(m_entries.begin());
+        EndUpdateLocked();
+    }
+
+    /**
+     * @brief Stop coalescing changes.
+     */
+    void EndUpdate()
+    {
+        lock_guard<Mutex> lock(this->GetMutex()); // Ensure thread-safety.
+        EndUpdateLocked();
+    }
+
+private:
+    struct Pending
+    {
+        CollectionChange kind; /// What happened.
+        K key; /// The key of the entry.
+        optional<V> oldValue; /// The erased or replaced value.
+        optional<V> newValue; /// The inserted or new value.
+    };
+
+    void EraseLocked(typename Map::iterator entry)
+    {
+        if (!this->Observed())
+        {
+            m_entries.erase(entry);
+            return;
+        }
+        auto node = m_entries.extract(entry); // Keeps the key and value alive for the callbacks.
+        Changed(CollectionChange::Erase, node.key(), &node.mapped(), nullptr);
+    }
+
+    /**
+     * @brief Report an edit now, or record it while batching. Must be called with the lock held.
+     * @param kind What happened.
+     * @param position Where it happened.
+     * @param oldValue The erased or replaced value, moved from when recorded; null for inserts.
+     * @param newValue The inserted or new value, null for erasures.
+     */
+    void Changed(CollectionChange kind, const K& position, V* oldValue, const V* newValue)
+    {
+        if (this->m_updateDepth == 0)
+        {
+            const Change change{ kind, &position, oldValue, newValue };
+            return this->NotifyCallbacks(&change, 1);
+        }
+        Pending& pending = m_pending.emplace_back(Pending{ kind, position, nullopt, nullopt });
+        if (oldValue)
+            pending.oldValue.emplace(std::move(*oldValue)); // Only ever a value about to be dropped.
+        if (newValue)
+            pending.newValue.emplace(*newValue);
+    }
+
+    void EndUpdateLocked()
+    {
+        if (!this->LeaveUpdate() || m_pending.empty())
+            return;
+        vector<Pending> pending;
+        pending.swap(m_pending);
+        vector<Change> changes;
+        changes.reserve(pending.size());
+        for (const Pending& edit : pending)
+            changes.push_back({ edit.kind, &edit.key, edit.oldValue ? &*edit.oldValue : nullptr, edit.newValue ? &*edit.newValue : nullptr });
+        this->NotifyCallbacks(changes.data(), changes.size());
+    }
+
+    Map m_entries; /// The entries.
+    vector<Pending> m_pending; /// Edits recorded during the current batch.
+};
@@ -0,0 +1,318 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "property_dispatcher.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#include <coroutine>
+#define PROPERTY_COROUTINES 1
+#endif
+
+using namespace std;
+
+namespace PropertyInternals
+{
+#ifdef PROPERTY_COROUTINES
+    /**
+     * @brief Holds back coroutine resumptions while this thread notifies under a property lock.
+     *
+     * A coroutine resumed inside an in-lock change callback would run, and
+     * likely await the same property again, with the lock still held. Instead,
+     * resumptions are queued until the outermost guard of the thread is released,
+     * after the lock.
+     */
+    struct ResumeGuard
+    {
+        ResumeGuard()
+        {
+            ++GetState().depth;
+        }
+
+        ResumeGuard(const ResumeGuard&) = delete;
+        ResumeGuard& operator=(const ResumeGuard&) = delete;
+
+        ~ResumeGuard()
+        {
+            Release();
+        }
+
+        /**
+         * @brief Stop holding back; the outermost guard resumes the queued coroutines.
+         */
+        void Release()
+        {
+            if (m_released)
+                return;
+            m_released = true;
+            State& state = GetState();
+            if (--state.depth > 0)
+                return;
+            while (!state.queue.empty())
+            {
+                vector<coroutine_handle<>> queue;
+                queue.swap(state.queue); // Resumed coroutines may queue more.
+                for (coroutine_handle<> handle : queue)
+                    handle.resume();
+            }
+        }
+
+        /**
+         * @brief Resume a coroutine now, or once the outermost guard of the thread is released.
+         * @param handle The coroutine.
+         */
+        static void Resume(coroutine_handle<> handle)
+        {
+            State& state = GetState();
+            if (state.depth > 0)
+                state.queue.push_back(handle);
+            else
+                handle.resume();
+        }
+
+    private:
+        struct State
+        {
+            size_t depth = 0; /// Number of live guards on the thread.
+            vector<coroutine_handle<>> queue; /// Coroutines to resume once the count drops to zero.
+        };
+
+        static State& GetState()
+        {
+            static thread_local State state;
+            return state;
+        }
+
+        bool m_released = false; /// Whether `Release` already ran.
+    };
+#else
+    struct ResumeGuard
+    {
+        void Release() {}
+    };
+#endif
+}
+
+#ifdef PROPERTY_COROUTINES
+
+namespace PropertyInternals
+{
+    template<typename T>
+    struct WaitList;
+
+    /**
+     * @brief Something waiting in a `WaitList` for a value.
+     */
+    template<typename T>
+    struct Waiter
+    {
+        /**
+         * @brief Offer a value. Called with the wait list locked, or before the waiter is listed.
+         * @param value The new value.
+         * @return true to stop waiting; the waiter is then removed and woken.
+         */
+        virtual bool Offer(const T& value) = 0;
+
+        /**
+         * @brief Resume whatever waited. Called once, after the waiter was removed.
+         */
+        virtual void Wake() = 0;
+
+        shared_ptr<WaitList<T>> list; /// The list the waiter was added to, set by `WaitList::Add` before it can be woken.
+
+    protected:
+        ~Waiter() = default;
+    };
+
+    /**
+     * @brief Waiters of one property, fed by a single change callback.
+     *
+     * However many coroutines wait, the property has one callback; waiters
+     * add and remove themselves under the list's own mutex.
+     */
+    template<typename T>
+    struct WaitList : enable_shared_from_this<WaitList<T>>
+    {
+        /**
+         * @brief List a waiter. Called with the property lock held.
+         *
+         * Once this returns, another thread may already have woken and
+         * destroyed the waiter, so the caller must not touch it again.
+         *
+         * @param waiter The waiter; must stay alive until woken or removed.
+         */
+        void Add(Waiter<T>& waiter)
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            waiter.list = this->shared_from_this(); // Before the waiter is visible to Notify.
+            m_waiters.push_back(&waiter);
+            m_count.store(m_waiters.size(), memory_order_relaxed);
+        }
+
+        /**
+         * @brief Unlist a waiter that gave up, unless it was already woken.
+         * @param waiter The waiter.
+         * @return false if it was already woken.
+         */
+        bool Remove(Waiter<T>& waiter)
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            auto found = find(m_waiters.begin(), m_waiters.end(), &waiter);
+            if (found == m_waiters.end())
+                return false;
+            m_waiters.erase(found);
+            m_count.store(m_waiters.size(), memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Offer a new value to every waiter and wake those done waiting.
+         * @param value The new value.
+         */
+        void Notify(const T& value)
+        {
+            if (m_count.load(memory_order_relaxed) == 0)
+                return; // Nobody waits; skip the mutex.
+            vector<Waiter<T>*> woken;
+            {
+                lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+                auto kept = remove_if(m_waiters.begin(), m_waiters.end(), [&](Waiter<T>* waiter)
+                {
+                    if (!waiter->Offer(value))
+                        return false;
+                    woken.push_back(waiter);
+                    return true;
+                });
+                m_waiters.erase(kept, m_waiters.end());
+                m_count.store(m_waiters.size(), memory_order_relaxed);
+            }
+            for (Waiter<T>* waiter : woken)
+                waiter->Wake(); // May destroy the waiter.
+        }
+
+    private:
+        mutex m_mutex; /// Mutex for thread-safe access.
+        vector<Waiter<T>*> m_waiters; /// Waiters, in the order they started waiting.
+        atomic<size_t> m_count{ 0 }; /// Size of `m_waiters`, read without the mutex.
+    };
+
+    /**
+     * @brief Predicate of `Property::Changed`: any new value will do.
+     */
+    struct AnyValue
+    {
+        template<typename T>
+        bool operator()(const T&) const
+        {
+            return true;
+        }
+    };
+}
+
+/**
+ * @brief Awaitable returned by `Property::Changed` and `Property::When`.
+ *
+ * Suspends the coroutine until the property holds a value accepted by the
+ * predicate, then resumes it with that value. The coroutine is resumed by the
+ * notification of the change: on `resumeOn` if given, otherwise on the
+ * property's dispatcher if it has one, otherwise on the writing thread once it
+ * has released the property lock.
+ *
+ * The check of the current value and the start of the wait happen under the
+ * property lock, so a change made in between is never missed.
+ */
+template<typename Owner, typename T, typename Predicate>
+struct PropertyChangeAwaiter : private PropertyInternals::Waiter<T>
+{
+    /**
+     * @brief Constructor.
+     * @param owner The property to wait on.
+     * @param predicate Called as `predicate(const T&)` with each candidate value.
+     * @param checkCurrent Whether the current value may satisfy the wait.
+     * @param resumeOn Executor to resume on, or nullptr.
+     */
+    PropertyChangeAwaiter(Owner& owner, Predicate predicate, bool checkCurrent, shared_ptr<PropertyDispatcher> resumeOn)
+        : m_owner(owner), m_predicate(std::move(predicate)), m_checkCurrent(checkCurrent), m_resumeOn(std::move(resumeOn)) {}
+
+    PropertyChangeAwaiter(const PropertyChangeAwaiter&) = delete;
+    PropertyChangeAwaiter& operator=(const PropertyChangeAwaiter&) = delete;
+
+    /**
+     * @brief Destructor. Stops waiting if the coroutine is destroyed while suspended.
+     */
+    ~PropertyChangeAwaiter()
+    {
+        if (shared_ptr<PropertyInternals::WaitList<T>> list = std::move(this->list))
+            list->Remove(*this); // Does nothing if the waiter was woken.
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(coroutine_handle<> handle)
+    {
+        m_handle = handle; // Before the waiter is listed and can be woken.
+        return m_owner.AddWaiter(*this, m_checkCurrent); // May resume and destroy the coroutine on another thread before returning.
+    }
+
+    T await_resume()
+    {
+        return std::move(*m_result);
+    }
+
+private:
+    bool Offer(const T& value) override
+    {
+        if (!m_predicate(value))
+            return false;
+        m_result.emplace(value);
+        return true;
+    }
+
+    void Wake() override
+    {
+        if (m_resumeOn)
+            m_resumeOn->Post([handle = m_handle] { handle.resume(); });
+        else
+            PropertyInternals::ResumeGuard::Resume(m_handle); // After the property lock, if notified under it.
+    }
+
+    Owner& m_owner; /// The property waited on.
+    Predicate m_predicate; /// Accepts the value to resume with.
+    bool m_checkCurrent; /// Whether the current value may satisfy the wait.
+    shared_ptr<PropertyDispatcher> m_resumeOn; /// Executor to resume on, or null.
+    coroutine_handle<> m_handle; /// The suspended coroutine.
+    optional<T> m_result; /// The accepted value.
+};
+
+#endif
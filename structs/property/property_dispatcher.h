@@ -0,0 +1,192 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * @brief Executor that change notifications are posted to.
+ *
+ * A property with a dispatcher only enqueues its change callbacks on the
+ * writer's thread; the dispatcher decides where and when they run.
+ */
+struct PropertyDispatcher
+{
+    /**
+     * @brief Type definition for a posted task.
+     */
+    using Task = function<void()>;
+
+    virtual ~PropertyDispatcher() = default;
+
+    /**
+     * @brief Queue a task for execution. Must be safe to call from any thread.
+     * @param task The task to run.
+     */
+    virtual void Post(Task task) = 0;
+};
+
+/**
+ * @brief Dispatcher running every task immediately on the posting thread.
+ */
+struct InlineDispatcher : PropertyDispatcher
+{
+    void Post(Task task) override
+    {
+        task();
+    }
+};
+
+/**
+ * @brief Dispatcher queuing tasks until the owning thread drains them.
+ *
+ * Meant for event loops and UI threads: post from anywhere, then call
+ * `RunPending` (or `WaitAndRunPending`) from the thread that should run the
+ * callbacks. Tasks run in the order they were posted.
+ */
+struct QueueDispatcher : PropertyDispatcher
+{
+    void Post(Task task) override
+    {
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_tasks.push_back(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+    /**
+     * @brief Run every task queued so far on the calling thread.
+     * @return The number of tasks that were run.
+     */
+    size_t RunPending()
+    {
+        deque<Task> tasks;
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            tasks.swap(m_tasks);
+        }
+        for (Task& task : tasks)
+            task();
+        return tasks.size();
+    }
+
+    /**
+     * @brief Wait until at least one task is queued, then run every queued task.
+     * @param timeout The maximum time to wait.
+     * @return The number of tasks that were run.
+     */
+    template<typename Rep, typename Period>
+    size_t WaitAndRunPending(const chrono::duration<Rep, Period>& timeout)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_condition.wait_for(lock, timeout, [this] { return !m_tasks.empty(); });
+        }
+        return RunPending();
+    }
+
+private:
+    deque<Task> m_tasks; /// Tasks waiting to be run.
+    mutex m_mutex; /// Mutex for thread-safe access.
+    condition_variable m_condition; /// Signaled when a task is posted.
+};
+
+/**
+ * @brief Dispatcher running tasks on a fixed set of worker threads.
+ *
+ * With more than one thread, callbacks for successive changes may run
+ * concurrently and complete out of order; use a single thread to keep order.
+ * Queued tasks are still run when the dispatcher is destroyed.
+ */
+struct ThreadPoolDispatcher : PropertyDispatcher
+{
+    /**
+     * @brief Start the worker threads.
+     * @param threadCount The number of worker threads, at least one.
+     */
+    explicit ThreadPoolDispatcher(size_t threadCount = thread::hardware_concurrency())
+    {
+        if (threadCount == 0)
+            threadCount = 1;
+        m_workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i)
+            m_workers.emplace_back([this] { Work(); });
+    }
+
+    ThreadPoolDispatcher(const ThreadPoolDispatcher&) = delete;
+    ThreadPoolDispatcher& operator=(const ThreadPoolDispatcher&) = delete;
+
+    ~ThreadPoolDispatcher() override
+    {
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (thread& worker : m_workers)
+            worker.join();
+    }
+
+    void Post(Task task) override
+    {
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_tasks.push_back(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+private:
+    void Work()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                unique_lock<mutex> lock(m_mutex); // Ensure thread-safety.
+                m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return; // Stopping and nothing left to run.
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    vector<thread> m_workers; /// The worker threads.
+    deque<Task> m_tasks; /// Tasks waiting to be run.
+    mutex m_mutex; /// Mutex for thread-safe access.
+    condition_variable m_condition; /// Signaled when a task is posted or the pool stops.
+    bool m_stopping = false; /// Set when the pool is being destroyed.
+};
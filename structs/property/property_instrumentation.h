@@ -0,0 +1,490 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Lock-free histogram of durations with power-of-two nanosecond buckets.
+ *
+ * Bucket `i` counts durations below 2^i ns and at least 2^(i-1) ns; bucket 0
+ * counts zero durations. Recording is a few relaxed atomic increments.
+ */
+struct LatencyHistogram
+{
+    /// Number of buckets; the last one also counts everything longer.
+    static constexpr size_t BucketCount = 40;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Record a duration.
+     * @param duration The duration to record.
+     */
+    void Record(chrono::nanoseconds duration)
+    {
+        const uint64_t nanos = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+        size_t bucket = 0;
+        for (uint64_t rest = nanos; rest != 0 && bucket + 1 < BucketCount; rest >>= 1)
+            ++bucket;
+        m_buckets[bucket].fetch_add(1, memory_order_relaxed);
+        m_count.fetch_add(1, memory_order_relaxed);
+        m_totalNanos.fetch_add(nanos, memory_order_relaxed);
+        uint64_t max = m_maxNanos.load(memory_order_relaxed);
+        while (nanos > max && !m_maxNanos.compare_exchange_weak(max, nanos, memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Get the number of recorded durations.
+     */
+    uint64_t Count() const
+    {
+        return m_count.load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the sum of the recorded durations.
+     */
+    chrono::nanoseconds Total() const
+    {
+        return chrono::nanoseconds(m_totalNanos.load(memory_order_relaxed));
+    }
+
+    /**
+     * @brief Get the longest recorded duration.
+     */
+    chrono::nanoseconds Max() const
+    {
+        return chrono::nanoseconds(m_maxNanos.load(memory_order_relaxed));
+    }
+
+    /**
+     * @brief Get the number of durations in one bucket.
+     * @param index The bucket, below `BucketCount`.
+     */
+    uint64_t Bucket(size_t index) const
+    {
+        return m_buckets[index].load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Estimate a percentile.
+     * @param fraction The percentile as a fraction, e.g. 0.99.
+     * @return The upper bound of the bucket holding that percentile.
+     */
+    chrono::nanoseconds Percentile(double fraction) const
+    {
+        const uint64_t count = Count();
+        if (count == 0)
+            return chrono::nanoseconds(0);
+        const uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t index = 0; index < BucketCount; ++index)
+        {
+            seen += Bucket(index);
+            if (seen >= rank)
+                return chrono::nanoseconds(index == 0 ? 0 : int64_t(1) << index);
+        }
+        return Max();
+    }
+
+    /**
+     * @brief Forget every recorded duration.
+     */
+    void Reset()
+    {
+        for (atomic<uint64_t>& bucket : m_buckets)
+            bucket.store(0, memory_order_relaxed);
+        m_count.store(0, memory_order_relaxed);
+        m_totalNanos.store(0, memory_order_relaxed);
+        m_maxNanos.store(0, memory_order_relaxed);
+    }
+
+    /**
+     * @brief Write the histogram as a JSON object.
+     * @param out The stream to write to.
+     */
+    void WriteJson(ostream& out) const
+    {
+        out << "{\"count\":" << Count() << ",\"totalNanos\":" << Total().count() << ",\"maxNanos\":" << Max().count()
+            << ",\"p50Nanos\":" << Percentile(0.5).count() << ",\"p99Nanos\":" << Percentile(0.99).count() << ",\"buckets\":[";
+        size_t last = BucketCount;
+        while (last > 0 && Bucket(last - 1) == 0)
+            --last; // Trailing empty buckets are left out.
+        for (size_t index = 0; index < last; ++index)
+            out << (index ? "," : "") << Bucket(index);
+        out << "]}";
+    }
+
+private:
+    atomic<uint64_t> m_buckets[BucketCount] = {}; /// Durations per bucket.
+    atomic<uint64_t> m_count{ 0 }; /// Number of recorded durations.
+    atomic<uint64_t> m_totalNanos{ 0 }; /// Sum of the recorded durations.
+    atomic<uint64_t> m_maxNanos{ 0 }; /// Longest recorded duration.
+};
+
+/**
+ * @brief Counters and latency histograms of one instrumented property.
+ *
+ * Shared between the property and the notifications it posts, so it stays
+ * valid while callbacks dispatched before the property was destroyed still run.
+ * Every instance is listed in `PropertyStatsRegistry` while it is alive.
+ */
+struct PropertyStats
+{
+    /**
+     * @brief Create statistics and list them in `PropertyStatsRegistry`.
+     */
+    static shared_ptr<PropertyStats> Create();
+
+    /**
+     * @brief Name the property in reports.
+     * @param name The name.
+     */
+    void SetName(string name)
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        m_name = std::move(name);
+    }
+
+    /**
+     * @brief Get the name set with `SetName`, empty by default.
+     */
+    string Name() const
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        return m_name;
+    }
+
+    /**
+     * @brief Get the number of `Set` calls and assignments, changing or not.
+     */
+    uint64_t Writes() const
+    {
+        return m_writes.load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of committed changes, including those received through bindings.
+     */
+    uint64_t Changes() const
+    {
+        return m_changes.load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of values rejected by the static or runtime validator.
+     */
+    uint64_t Rejected() const
+    {
+        return m_rejected.load(memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the time writers waited for the property lock, one entry per acquisition.
+     */
+    const LatencyHistogram& LockWait() const
+    {
+        return m_lockWait;
+    }
+
+    /**
+     * @brief Visit the execution time histogram of every callback run at least once.
+     * @param visitor Called as `visitor(size_t callbackID, const LatencyHistogram& histogram)`.
+     */
+    template<typename Visitor>
+    void ForEachCallback(Visitor&& visitor) const
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        for (const auto& entry : m_callbacks)
+            visitor(entry.first, *entry.second);
+    }
+
+    /**
+     * @brief Zero every counter and histogram.
+     */
+    void Reset()
+    {
+        m_writes.store(0, memory_order_relaxed);
+        m_changes.store(0, memory_order_relaxed);
+        m_rejected.store(0, memory_order_relaxed);
+        m_lockWait.Reset();
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        m_callbacks.clear();
+    }
+
+    /**
+     * @brief Write the statistics as a JSON object.
+     * @param out The stream to write to.
+     */
+    void WriteJson(ostream& out) const
+    {
+        out << "{\"name\":";
+        WriteJsonString(out, Name());
+        out << ",\"writes\":" << Writes() << ",\"changes\":" << Changes() << ",\"rejected\":" << Rejected() << ",\"lockWait\":";
+        m_lockWait.WriteJson(out);
+        out << ",\"callbacks\":[";
+        bool first = true;
+        ForEachCallback([&](size_t id, const LatencyHistogram& histogram)
+        {
+            out << (first ? "" : ",") << "{\"id\":" << id << ",\"time\":";
+            histogram.WriteJson(out);
+            out << "}";
+            first = false;
+        });
+        out << "]}";
+    }
+
+    void RecordWrite() { m_writes.fetch_add(1, memory_order_relaxed); }
+    void RecordChange() { m_changes.fetch_add(1, memory_order_relaxed); }
+    void RecordRejected() { m_rejected.fetch_add(1, memory_order_relaxed); }
+    void RecordLockWait(chrono::nanoseconds duration) { m_lockWait.Record(duration); }
+
+    /**
+     * @brief Record one execution of a callback.
+     * @param id The ID of the callback.
+     * @param duration How long it ran.
+     */
+    void RecordCallback(size_t id, chrono::nanoseconds duration)
+    {
+        LatencyHistogram* histogram;
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            unique_ptr<LatencyHistogram>& slot = m_callbacks[id];
+            if (!slot)
+                slot = make_unique<LatencyHistogram>();
+            histogram = slot.get();
+        }
+        histogram->Record(duration); // Histograms are only freed by ForgetCallback and Reset.
+    }
+
+    /**
+     * @brief Drop the histogram of a removed callback.
+     * @param id The ID of the callback.
+     */
+    void ForgetCallback(size_t id)
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        m_callbacks.erase(id);
+    }
+
+    /**
+     * @brief Write a string as a JSON string literal.
+     * @param out The stream to write to.
+     * @param text The string.
+     */
+    static void WriteJsonString(ostream& out, const string& text)
+    {
+        static const char digits[] = "0123456789abcdef";
+        out << '"';
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u00" << digits[(c >> 4) & 0xF] << digits[c & 0xF];
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+private:
+    atomic<uint64_t> m_writes{ 0 }; /// Number of writes.
+    atomic<uint64_t> m_changes{ 0 }; /// Number of committed changes.
+    atomic<uint64_t> m_rejected{ 0 }; /// Number of rejected values.
+    LatencyHistogram m_lockWait; /// Time writers waited for the lock.
+    mutable mutex m_mutex; /// Mutex for thread-safe access to the name and callback histograms.
+    string m_name; /// Name used in reports.
+    unordered_map<size_t, unique_ptr<LatencyHistogram>> m_callbacks; /// Execution time per callback ID.
+};
+
+/**
+ * @brief Process-wide list of the statistics of every live instrumented property.
+ */
+struct PropertyStatsRegistry
+{
+    /**
+     * @brief Visit the statistics of every live instrumented property.
+     * @param visitor Called as `visitor(PropertyStats& stats)`.
+     */
+    template<typename Visitor>
+    static void ForEach(Visitor&& visitor)
+    {
+        vector<shared_ptr<PropertyStats>> alive;
+        {
+            State& state = GetState();
+            lock_guard<mutex> lock(state.mutex); // Ensure thread-safety.
+            for (const weak_ptr<PropertyStats>& entry : state.entries)
+                if (shared_ptr<PropertyStats> stats = entry.lock())
+                    alive.push_back(std::move(stats));
+        }
+        for (const shared_ptr<PropertyStats>& stats : alive)
+            visitor(*stats);
+    }
+
+    /**
+     * @brief Write the statistics of every live instrumented property as a JSON array.
+     * @param out The stream to write to.
+     */
+    static void WriteJson(ostream& out)
+    {
+        out << "[";
+        bool first = true;
+        ForEach([&](const PropertyStats& stats)
+        {
+            out << (first ? "" : ",");
+            stats.WriteJson(out);
+            first = false;
+        });
+        out << "]";
+    }
+
+    /**
+     * @brief List statistics. Called by `PropertyStats::Create`.
+     * @param stats The statistics to list.
+     */
+    static void Add(const shared_ptr<PropertyStats>& stats)
+    {
+        State& state = GetState();
+        lock_guard<mutex> lock(state.mutex); // Ensure thread-safety.
+        if (state.entries.size() >= state.pruneAt)
+        {
+            state.entries.erase(remove_if(state.entries.begin(), state.entries.end(),
+                [](const weak_ptr<PropertyStats>& entry) { return entry.expired(); }), state.entries.end());
+            state.pruneAt = state.entries.size() * 2 + 64; // Amortized O(1) per property.
+        }
+        state.entries.push_back(stats);
+    }
+
+private:
+    struct State
+    {
+        std::mutex mutex; /// Mutex for thread-safe access.
+        vector<weak_ptr<PropertyStats>> entries; /// Statistics, some of them expired.
+        size_t pruneAt = 64; /// Size at which expired entries are dropped.
+    };
+
+    static State& GetState()
+    {
+        static State state;
+        return state;
+    }
+};
+
+inline shared_ptr<PropertyStats> PropertyStats::Create()
+{
+    shared_ptr<PropertyStats> stats = make_shared<PropertyStats>();
+    PropertyStatsRegistry::Add(stats);
+    return stats;
+}
+
+namespace PropertyInternals
+{
+    /**
+     * @brief Instrumentation hooks of a property; every hook compiles to nothing when disabled.
+     */
+    template<bool Enabled>
+    struct Instrumentation
+    {
+        /// What posted notifications keep to record into.
+        struct Handle {};
+
+        Handle StatsHandle() const { return {}; }
+        void RecordWrite() const {}
+        void RecordChange() const {}
+        void RecordRejected() const {}
+        void ForgetCallback(size_t) const {}
+
+        template<typename Mutex>
+        unique_lock<Mutex> LockForWrite(Mutex& mutex) const
+        {
+            return unique_lock<Mutex>(mutex);
+        }
+
+        template<typename Callback, typename... Arguments>
+        static void Run(const Handle&, size_t, const Callback& callback, Arguments&... arguments)
+        {
+            callback(arguments...);
+        }
+    };
+
+    template<>
+    struct Instrumentation<true>
+    {
+        using Handle = shared_ptr<PropertyStats>;
+
+        Instrumentation() : m_stats(PropertyStats::Create()) {}
+
+        const Handle& StatsHandle() const { return m_stats; }
+        void RecordWrite() const { m_stats->RecordWrite(); }
+        void RecordChange() const { m_stats->RecordChange(); }
+        void RecordRejected() const { m_stats->RecordRejected(); }
+        void ForgetCallback(size_t id) const { m_stats->ForgetCallback(id); }
+
+        /**
+         * @brief Lock a mutex, recording how long it took. An uncontended lock reads no clock.
+         */
+        template<typename Mutex>
+        unique_lock<Mutex> LockForWrite(Mutex& mutex) const
+        {
+            unique_lock<Mutex> lock(mutex, try_to_lock);
+            if (lock.owns_lock())
+            {
+                m_stats->RecordLockWait(chrono::nanoseconds(0));
+                return lock;
+            }
+            const auto start = chrono::steady_clock::now();
+            lock.lock();
+            m_stats->RecordLockWait(chrono::steady_clock::now() - start);
+            return lock;
+        }
+
+        /**
+         * @brief Run a callback, recording how long it ran.
+         */
+        template<typename Callback, typename... Arguments>
+        static void Run(const Handle& stats, size_t id, const Callback& callback, Arguments&... arguments)
+        {
+            const auto start = chrono::steady_clock::now();
+            callback(arguments...);
+            stats->RecordCallback(id, chrono::steady_clock::now() - start);
+        }
+
+        Handle m_stats; /// The statistics of the property.
+    };
+}
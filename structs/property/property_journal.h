@@ -0,0 +1,273 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include "property.h"
+
+using namespace std;
+
+/**
+ * @brief What a full `PropertyJournal` does with a new event.
+ */
+enum class JournalOverflow
+{
+    DropNewest, /// Keep the recorded events and discard the new one.
+    OverwriteOldest, /// Discard the oldest undrained event to make room.
+};
+
+/**
+ * @brief One recorded change.
+ */
+template<typename T>
+struct JournalEntry
+{
+    uint64_t sequence = 0; /// Position in the journal; gaps mean events were dropped.
+    uint32_t source = 0; /// Tag given to `Attach`, telling the properties of a group apart.
+    chrono::steady_clock::time_point time; /// When the change was recorded.
+    T oldValue{}; /// The value before the change.
+    T newValue{}; /// The value after the change.
+};
+
+/**
+ * @brief Bounded lock-free ring buffer of change events, drained by a background consumer.
+ *
+ * Attaching a journal registers a change callback that only copies the old
+ * and new values into a preallocated slot, so recording costs a timestamp and
+ * two copies instead of formatting and I/O on the writer's thread. Several
+ * properties, and several writer threads, may record into one journal; each
+ * event carries the tag given when its property was attached.
+ *
+ * Memory is bounded by the capacity, fixed at construction. When the journal
+ * is full, `JournalOverflow` decides whether the new event or the oldest one is
+ * discarded; either way `Dropped` counts it.
+ *
+ * The ring is a bounded multi-producer multi-consumer queue with a sequence
+ * number per slot. `T` must be default constructible and copy assignable.
+ * The state is shared with the callbacks, so the journal may be destroyed
+ * before the properties it is attached to.
+ */
+template<typename T>
+struct PropertyJournal
+{
+    /**
+     * @brief Type definition for a drained event.
+     */
+    using Entry = JournalEntry<T>;
+
+    /**
+     * @brief Constructor.
+     * @param capacity The number of events kept, rounded up to a power of two.
+     * @param overflow What to do with new events when full.
+     */
+    explicit PropertyJournal(size_t capacity, JournalOverflow overflow = JournalOverflow::DropNewest)
+        : m_ring(make_shared<Ring>(capacity, overflow)) {}
+
+    PropertyJournal(const PropertyJournal&) = delete;
+    PropertyJournal& operator=(const PropertyJournal&) = delete;
+
+    /**
+     * @brief Record the changes of a property.
+     * @param property The property to journal.
+     * @param source The tag stored in each event of this property.
+     * @return The token owning the registration; destroy it to stop recording.
+     */
+    template<typename Policy>
+    [[nodiscard]] Subscription Attach(Property<T, Policy>& property, uint32_t source = 0)
+    {
+        return property.Subscribe([ring = m_ring, source](T& oldValue, T& newValue) { ring->Push(source, oldValue, newValue); });
+    }
+
+    /**
+     * @brief Record an event directly.
+     * @param source The tag of the event.
+     * @param oldValue The value before the change.
+     * @param newValue The value after the change.
+     * @return false if the journal was full and the event was dropped.
+     */
+    bool Record(uint32_t source, const T& oldValue, const T& newValue)
+    {
+        return m_ring->Push(source, oldValue, newValue);
+    }
+
+    /**
+     * @brief Remove recorded events in order and hand them to a visitor.
+     * @param visitor Called as `visitor(JournalEntry<T>& entry)` for each event.
+     * @param maxCount The maximum number of events to drain.
+     * @return The number of events drained.
+     */
+    template<typename Visitor>
+    size_t Drain(Visitor&& visitor, size_t maxCount = SIZE_MAX)
+    {
+        size_t count = 0;
+        Entry entry;
+        while (count < maxCount && m_ring->Pop(entry))
+        {
+            visitor(entry);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Get the number of events currently recorded; only a hint while writers are active.
+     */
+    size_t Size() const
+    {
+        const uint64_t tail = m_ring->tail.load(memory_order_acquire);
+        const uint64_t head = m_ring->head.load(memory_order_acquire);
+        return head > tail ? size_t(head - tail) : 0;
+    }
+
+    /**
+     * @brief Get the number of events the journal holds.
+     */
+    size_t Capacity() const
+    {
+        return m_ring->mask + 1;
+    }
+
+    /**
+     * @brief Get the number of events discarded because the journal was full.
+     */
+    uint64_t Dropped() const
+    {
+        return m_ring->dropped.load(memory_order_relaxed);
+    }
+
+private:
+    struct Slot
+    {
+        atomic<uint64_t> sequence{ 0 }; /// Position this slot is ready to be written (== position) or read (== position + 1) at.
+        Entry entry; /// The event.
+    };
+
+    struct Ring
+    {
+        Ring(size_t capacity, JournalOverflow overflow) : overflow(overflow)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            mask = size - 1;
+            slots = make_unique<Slot[]>(size);
+            for (size_t index = 0; index < size; ++index)
+                slots[index].sequence.store(index, memory_order_relaxed);
+        }
+
+        bool Push(uint32_t source, const T& oldValue, const T& newValue)
+        {
+            const chrono::steady_clock::time_point time = chrono::steady_clock::now();
+            uint64_t position = head.load(memory_order_relaxed);
+            for (;;)
+            {
+                Slot& slot = slots[position & mask];
+                const uint64_t sequence = slot.sequence.load(memory_order_acquire);
+                const int64_t difference = int64_t(sequence - position);
+                if (difference == 0)
+                {
+                    if (head.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                    {
+                        slot.entry.sequence = position;
+                        slot.entry.source = source;
+                        slot.entry.time = time;
+                        slot.entry.oldValue = oldValue;
+                        slot.entry.newValue = newValue;
+                        slot.sequence.store(position + 1, memory_order_release); // Publish to consumers.
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // Full: the slot still holds the event from one lap ago.
+                    if (overflow == JournalOverflow::DropNewest)
+                    {
+                        dropped.fetch_add(1, memory_order_relaxed);
+                        return false;
+                    }
+                    Discard(); // Fails only while the oldest event is still being written; then retry.
+                    position = head.load(memory_order_relaxed);
+                }
+                else
+                {
+                    position = head.load(memory_order_relaxed); // Another writer took this position.
+                }
+            }
+        }
+
+        bool Pop(Entry& out)
+        {
+            uint64_t position = tail.load(memory_order_relaxed);
+            for (;;)
+            {
+                Slot& slot = slots[position & mask];
+                const uint64_t sequence = slot.sequence.load(memory_order_acquire);
+                const int64_t difference = int64_t(sequence - (position + 1));
+                if (difference == 0)
+                {
+                    if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                    {
+                        out = std::move(slot.entry);
+                        slot.sequence.store(position + mask + 1, memory_order_release); // Free for the next lap.
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false; // Empty, or the next event is still being written.
+                }
+                else
+                {
+                    position = tail.load(memory_order_relaxed); // Another consumer took this position.
+                }
+            }
+        }
+
+        /**
+         * @brief Drop the oldest event to make room, on behalf of a writer.
+         * @return false if nothing could be dropped because the oldest event is still being written.
+         */
+        bool Discard()
+        {
+            Entry entry;
+            if (!Pop(entry))
+                return false;
+            dropped.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+
+        alignas(64) atomic<uint64_t> head{ 0 }; /// Next position to write.
+        alignas(64) atomic<uint64_t> tail{ 0 }; /// Next position to read.
+        alignas(64) atomic<uint64_t> dropped{ 0 }; /// Events discarded because the ring was full.
+        uint64_t mask = 0; /// Capacity minus one.
+        unique_ptr<Slot[]> slots; /// The events.
+        JournalOverflow overflow; /// What to do when full.
+    };
+
+    shared_ptr<Ring> m_ring; /// State shared with the attached callbacks.
+};
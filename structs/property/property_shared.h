@@ -0,0 +1,502 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include "property.h"
+
+#if __has_include(<sys/mman.h>)
+#define PROPERTY_SHARED_MEMORY
+#endif
+
+#ifdef PROPERTY_SHARED_MEMORY
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief How a `SharedProperty` gets its shared-memory segment.
+ */
+enum class SharedOpen
+{
+    OpenOrCreate, /// Open the segment, creating it with the initial value if it does not exist.
+    CreateOnly, /// Create the segment; fail if it exists.
+    OpenOnly, /// Open an existing segment; fail if it does not exist.
+};
+
+namespace PropertyInternals
+{
+    static_assert(atomic<uint32_t>::is_always_lock_free && atomic<uint64_t>::is_always_lock_free && atomic<size_t>::is_always_lock_free,
+        "Shared-memory properties need address-free atomics.");
+    static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "The futex word must be a plain 32-bit integer.");
+
+    /**
+     * @brief Block while a shared 32-bit word holds a value, or until a timeout.
+     *
+     * Uses a futex on Linux, which works across processes. Elsewhere it sleeps
+     * for at most a millisecond, so waiters poll.
+     *
+     * @param word The word, in shared memory.
+     * @param expected The value to wait on; returns at once if the word differs.
+     * @param timeout The maximum time to wait.
+     */
+    inline void WaitOnWord(atomic<uint32_t>& word, uint32_t expected, chrono::nanoseconds timeout)
+    {
+#ifdef __linux__
+        timespec time{ static_cast<time_t>(timeout.count() / 1000000000), static_cast<long>(timeout.count() % 1000000000) };
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &time, nullptr, 0); // Spurious and interrupted wakeups are rechecked by the caller.
+#else
+        if (word.load(memory_order_acquire) == expected)
+            this_thread::sleep_for(min<chrono::nanoseconds>(timeout, chrono::milliseconds(1)));
+#endif
+    }
+
+    /**
+     * @brief Wake every thread, in any process, blocked in `WaitOnWord` on a word.
+     */
+    inline void WakeOnWord(atomic<uint32_t>& word)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word; // Waiters poll.
+#endif
+    }
+
+    /**
+     * @brief POSIX shared-memory segment mapped for the lifetime of the object.
+     */
+    struct SharedMemorySegment
+    {
+        /**
+         * @brief Open or create and map a segment.
+         * @param name The name of the segment, starting with '/'.
+         * @param size The size of the segment in bytes.
+         * @param mode Whether to open, create or either.
+         * @throws system_error if the segment cannot be opened, created or mapped.
+         */
+        SharedMemorySegment(const string& name, size_t size, SharedOpen mode) : m_size(size)
+        {
+            int descriptor = -1;
+            if (mode != SharedOpen::OpenOnly)
+            {
+                descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+                if (descriptor >= 0)
+                    m_created = true;
+                else if (errno != EEXIST || mode == SharedOpen::CreateOnly)
+                    throw system_error(errno, system_category(), "shm_open " + name);
+            }
+            if (descriptor < 0)
+            {
+                descriptor = shm_open(name.c_str(), O_RDWR, 0);
+                if (descriptor < 0)
+                    throw system_error(errno, system_category(), "shm_open " + name);
+            }
+            int error = m_created ? Resize(descriptor) : WaitForSize(descriptor);
+            if (error == 0)
+            {
+                m_data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+                if (m_data == MAP_FAILED)
+                {
+                    m_data = nullptr;
+                    error = errno;
+                }
+            }
+            close(descriptor); // The mapping keeps the segment alive.
+            if (error != 0)
+            {
+                if (m_created)
+                    shm_unlink(name.c_str());
+                throw system_error(error, system_category(), "mapping " + name);
+            }
+        }
+
+        SharedMemorySegment(const SharedMemorySegment&) = delete;
+        SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+
+        ~SharedMemorySegment()
+        {
+            munmap(m_data, m_size);
+        }
+
+        /**
+         * @brief Get the start of the mapping.
+         */
+        void* Data() const
+        {
+            return m_data;
+        }
+
+        /**
+         * @brief Check whether this object created the segment.
+         */
+        bool Created() const
+        {
+            return m_created;
+        }
+
+    private:
+        int Resize(int descriptor) const
+        {
+            return ftruncate(descriptor, static_cast<off_t>(m_size)) == 0 ? 0 : errno;
+        }
+
+        /**
+         * @brief Wait for the creator to size the segment; mapping it earlier would fault on access.
+         */
+        int WaitForSize(int descriptor) const
+        {
+            auto deadline = chrono::steady_clock::now() + chrono::seconds(1);
+            for (;;)
+            {
+                struct stat status;
+                if (fstat(descriptor, &status) != 0)
+                    return errno;
+                if (static_cast<size_t>(status.st_size) == m_size)
+                    return 0;
+                if (status.st_size != 0 || chrono::steady_clock::now() > deadline)
+                    return status.st_size != 0 ? EINVAL : ETIMEDOUT; // Another layout, or the creator died.
+                this_thread::yield();
+            }
+        }
+
+        void* m_data = nullptr; /// The mapping.
+        size_t m_size; /// The size of the mapping.
+        bool m_created = false; /// Whether this object created the segment.
+    };
+
+    /**
+     * @brief Layout of the segment behind a `SharedProperty`.
+     */
+    template<typename T>
+    struct SharedCell
+    {
+        static constexpr uint32_t Magic = 0x50485350; /// "PSHP".
+
+        explicit SharedCell(const T& value) : value(value) {}
+
+        atomic<uint32_t> ready; /// Set once the creator has initialized the rest.
+        uint32_t magic = Magic; /// Identifies the layout.
+        uint32_t cellSize = sizeof(SharedCell); /// Catches processes built with other types.
+        uint32_t valueSize = sizeof(T); /// Catches processes built with other types.
+        atomic<uint32_t> changes{ 0 }; /// Bumped on every change; the word waiters block on.
+        atomic<uint32_t> waiters{ 0 }; /// The number of threads blocked on `changes`, so writers skip the wake call.
+        SpinLock::Mutex writeLock; /// Serializes writers across processes.
+        atomic<uint64_t> version{ 0 }; /// Number of changes made so far.
+        SeqLockStorage<T> value; /// The value, read without any lock.
+    };
+}
+
+/**
+ * @brief Property whose value lives in a named shared-memory segment, seen by every process that opens it.
+ *
+ * The value is kept in a sequence lock inside the segment, so `Get` in any
+ * process is a few atomic loads with no syscall. Writers serialize on a
+ * spinlock in the segment, bump a version counter and wake waiting processes
+ * through a futex, so a process can block in `WaitForChange` instead of
+ * polling.
+ *
+ * Each process keeps a local `Property<T, Policy>` mirroring the last value it
+ * was told about. Its validator, coerce callback, change callbacks and
+ * bindings work as usual: `Set` coerces and validates locally before
+ * publishing, and changes made by other processes are delivered to the local
+ * callbacks by `Poll` or `WaitAndPoll`, coalesced into one notification from
+ * the last delivered value to the current one. Local writes notify at once.
+ *
+ * `T` must be trivially copyable and default constructible, and every process
+ * must use the same type for a name. The segment outlives the processes until
+ * `Remove` is called. A process that dies while writing leaves the segment
+ * locked.
+ */
+template<typename T, typename Policy = PropertyPolicy<T>>
+struct SharedProperty
+{
+    static_assert(is_trivially_copyable<T>::value, "SharedProperty requires a trivially copyable type.");
+
+    /**
+     * @brief Type definition for the local property mirroring the shared value.
+     */
+    using Local = Property<T, Policy>;
+
+    using ChangeCallback = typename Local::ChangeCallback;
+    using Validator = typename Local::Validator;
+    using CoerceCallback = typename Local::CoerceCallback;
+    using CallbackID = typename Local::CallbackID;
+
+    /**
+     * @brief Open or create a shared property.
+     * @param name The name of the segment; a leading '/' is added if missing.
+     * @param initialValue The value of a newly created segment.
+     * @param mode Whether to open, create or either.
+     * @throws system_error if the segment cannot be mapped, runtime_error if it holds another layout.
+     */
+    explicit SharedProperty(const string& name, T initialValue = T(), SharedOpen mode = SharedOpen::OpenOrCreate)
+        : m_segment(SegmentName(name), sizeof(Cell), mode), m_cell(Attach(m_segment, initialValue)),
+          m_seen(m_cell->version.load(memory_order_acquire)), m_local(m_cell->value.Load()) {}
+
+    SharedProperty(const SharedProperty&) = delete;
+    SharedProperty& operator=(const SharedProperty&) = delete;
+
+    /**
+     * @brief Remove a segment. Processes that have it mapped keep using it.
+     * @param name The name of the segment.
+     * @return true if the segment existed.
+     */
+    static bool Remove(const string& name)
+    {
+        return shm_unlink(SegmentName(name).c_str()) == 0;
+    }
+
+    /**
+     * @brief Check whether this process created the segment.
+     */
+    bool Created() const
+    {
+        return m_segment.Created();
+    }
+
+    /**
+     * @brief Get the current shared value without a lock or syscall.
+     */
+    T Get() const
+    {
+        return m_cell->value.Load();
+    }
+
+    /**
+     * @brief Get the current shared value.
+     */
+    operator T() const
+    {
+        return Get();
+    }
+
+    /**
+     * @brief Coerce, validate and publish a new value, then notify the local callbacks.
+     * @param newValue The new value.
+     * @return true if the shared value was changed, false otherwise.
+     */
+    bool Set(T newValue)
+    {
+        if (!m_local.Admit(newValue))
+            return false;
+        {
+            lock_guard<SpinLock::Mutex> lock(m_cell->writeLock); // Serialize writers across processes.
+            if (!typename Policy::Comparator{}(m_cell->value.Load(), newValue))
+                return false;
+            m_cell->value.Store(std::move(newValue));
+            m_cell->version.fetch_add(1, memory_order_release);
+            m_cell->changes.fetch_add(1, memory_order_seq_cst);
+        }
+        if (m_cell->waiters.load(memory_order_seq_cst) != 0)
+            PropertyInternals::WakeOnWord(m_cell->changes);
+        Poll(); // Notify the local callbacks.
+        return true;
+    }
+
+    /**
+     * @brief Assign a new value.
+     */
+    SharedProperty& operator=(const T& newValue)
+    {
+        Set(newValue);
+        return *this;
+    }
+
+    /**
+     * @brief Get the number of changes made to the shared value by every process.
+     */
+    uint64_t Version() const
+    {
+        return m_cell->version.load(memory_order_acquire);
+    }
+
+    /**
+     * @brief Deliver a change made since the last delivery to the local callbacks.
+     *
+     * Costs one atomic load when nothing changed.
+     *
+     * @return true if the local value changed and callbacks were notified.
+     */
+    bool Poll()
+    {
+        if (m_cell->version.load(memory_order_acquire) == m_seen.load(memory_order_relaxed))
+            return false;
+        unsigned char oldBytes[sizeof(T)];
+        bool changed;
+        {
+            lock_guard<mutex> lock(m_deliveryMutex); // Keep the local value in version order.
+            uint64_t version = m_cell->version.load(memory_order_acquire); // Before the value, so a newer value is redelivered at worst.
+            if (version == m_seen.load(memory_order_relaxed))
+                return false;
+            T value = m_cell->value.Load();
+            m_seen.store(version, memory_order_relaxed);
+            changed = m_local.RestoreBytes(addressof(value), oldBytes);
+        }
+        if (changed)
+            m_local.NotifyRestored(oldBytes); // Outside the delivery lock, so callbacks may write.
+        return changed;
+    }
+
+    /**
+     * @brief Block until the shared value has changed past a version, or until a timeout.
+     * @param version The version the caller has seen.
+     * @param timeout The maximum time to wait.
+     * @return true if the version differs from `version`.
+     */
+    template<typename Rep, typename Period>
+    bool WaitForChange(uint64_t version, const chrono::duration<Rep, Period>& timeout) const
+    {
+        auto deadline = chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            uint32_t changes = m_cell->changes.load(memory_order_acquire);
+            if (m_cell->version.load(memory_order_acquire) != version)
+                return true;
+            auto remaining = deadline - chrono::steady_clock::now();
+            if (remaining <= remaining.zero())
+                return false;
+            m_cell->waiters.fetch_add(1, memory_order_seq_cst);
+            PropertyInternals::WaitOnWord(m_cell->changes, changes, chrono::duration_cast<chrono::nanoseconds>(remaining));
+            m_cell->waiters.fetch_sub(1, memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Wait for a change not delivered yet, then deliver it.
+     * @param timeout The maximum time to wait.
+     * @return true if the local value changed and callbacks were notified.
+     */
+    template<typename Rep, typename Period>
+    bool WaitAndPoll(const chrono::duration<Rep, Period>& timeout)
+    {
+        return WaitForChange(m_seen.load(memory_order_relaxed), timeout) && Poll();
+    }
+
+    /**
+     * @brief Add a change callback, run by `Set` for local writes and by `Poll` for remote ones.
+     */
+    CallbackID AddChangeCallback(ChangeCallback callback)
+    {
+        return m_local.AddChangeCallback(std::move(callback));
+    }
+
+    /**
+     * @brief Add a change callback owned by the returned token.
+     */
+    [[nodiscard]] Subscription Subscribe(ChangeCallback callback)
+    {
+        return m_local.Subscribe(std::move(callback));
+    }
+
+    /**
+     * @brief Remove a change callback by ID.
+     */
+    void RemoveChangeCallback(CallbackID id)
+    {
+        m_local.RemoveChangeCallback(id);
+    }
+
+    /**
+     * @brief Set the validator applied to local writes.
+     */
+    void SetValidator(Validator validator)
+    {
+        m_local.SetValidator(std::move(validator));
+    }
+
+    /**
+     * @brief Set the coerce callback applied to local writes.
+     */
+    void SetCoerceCallback(CoerceCallback coerceCallback)
+    {
+        m_local.SetCoerceCallback(std::move(coerceCallback));
+    }
+
+    /**
+     * @brief Get the local mirror, e.g. to bind other properties one-way from it.
+     *
+     * Writing to the mirror does not publish; use `Set`.
+     */
+    Local& Mirror()
+    {
+        return m_local;
+    }
+
+private:
+    using Cell = PropertyInternals::SharedCell<T>;
+
+    static string SegmentName(const string& name)
+    {
+        return !name.empty() && name[0] == '/' ? name : '/' + name;
+    }
+
+    /**
+     * @brief Initialize a new segment, or check the layout of an existing one.
+     */
+    static Cell* Attach(const PropertyInternals::SharedMemorySegment& segment, const T& initialValue)
+    {
+        if (segment.Created())
+        {
+            Cell* cell = new (segment.Data()) Cell(initialValue);
+            cell->ready.store(1, memory_order_release); // Publish the initialized cell.
+            return cell;
+        }
+        Cell* cell = static_cast<Cell*>(segment.Data());
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(1);
+        while (cell->ready.load(memory_order_acquire) == 0)
+        {
+            if (chrono::steady_clock::now() > deadline)
+                throw runtime_error("SharedProperty: segment was never initialized");
+            this_thread::yield();
+        }
+        if (cell->magic != Cell::Magic || cell->cellSize != sizeof(Cell) || cell->valueSize != sizeof(T))
+            throw runtime_error("SharedProperty: segment holds another layout");
+        return cell;
+    }
+
+    PropertyInternals::SharedMemorySegment m_segment; /// The mapped segment.
+    Cell* m_cell; /// The shared state, inside the segment.
+    atomic<uint64_t> m_seen; /// The version last delivered to the local property.
+    Local m_local; /// Mirror of the last delivered value, with the callbacks and validation.
+    mutex m_deliveryMutex; /// Serializes deliveries to the local property.
+};
+#endif
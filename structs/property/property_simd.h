@@ -0,0 +1,249 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#if !defined(PROPERTY_NO_SIMD) && (defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <immintrin.h>
+#define PROPERTY_SIMD_X86 1
+#elif !defined(PROPERTY_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PROPERTY_SIMD_NEON 1
+#endif
+
+using namespace std;
+
+namespace PropertyInternals
+{
+    /**
+     * @brief Vector operations on `T`, specialized for the instruction set the code is compiled for.
+     *
+     * `Width` is 0 when there is no vector path for `T`, and the span kernels
+     * below then run their scalar loop only. Define `PROPERTY_NO_SIMD` to force
+     * the scalar loops everywhere. Comparisons are ordered and `Clamp` keeps
+     * NaN (x86 `min`/`max` return their second operand for NaN and equal
+     * zeros), so results match the scalar code.
+     */
+    template<typename T>
+    struct SimdOps
+    {
+        static constexpr size_t Width = 0;
+    };
+
+#if defined(PROPERTY_SIMD_X86) && defined(__AVX__)
+    template<>
+    struct SimdOps<float>
+    {
+        using Vector = __m256;
+        using Mask = __m256;
+        static constexpr size_t Width = 8;
+        static Vector Load(const float* values) { return _mm256_loadu_ps(values); }
+        static void Store(float* values, Vector vector) { _mm256_storeu_ps(values, vector); }
+        static Vector Splat(float value) { return _mm256_set1_ps(value); }
+        static Mask Less(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static Mask NotFinite(Vector a) { return _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a), _mm256_set1_ps(numeric_limits<float>::max()), _CMP_NLE_UQ); }
+        static Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return _mm256_max_ps(low, _mm256_min_ps(high, a)); }
+        static bool Any(Mask mask) { return _mm256_movemask_ps(mask) != 0; }
+    };
+
+    template<>
+    struct SimdOps<double>
+    {
+        using Vector = __m256d;
+        using Mask = __m256d;
+        static constexpr size_t Width = 4;
+        static Vector Load(const double* values) { return _mm256_loadu_pd(values); }
+        static void Store(double* values, Vector vector) { _mm256_storeu_pd(values, vector); }
+        static Vector Splat(double value) { return _mm256_set1_pd(value); }
+        static Mask Less(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static Mask NotFinite(Vector a) { return _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a), _mm256_set1_pd(numeric_limits<double>::max()), _CMP_NLE_UQ); }
+        static Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return _mm256_max_pd(low, _mm256_min_pd(high, a)); }
+        static bool Any(Mask mask) { return _mm256_movemask_pd(mask) != 0; }
+    };
+#elif defined(PROPERTY_SIMD_X86)
+    template<>
+    struct SimdOps<float>
+    {
+        using Vector = __m128;
+        using Mask = __m128;
+        static constexpr size_t Width = 4;
+        static Vector Load(const float* values) { return _mm_loadu_ps(values); }
+        static void Store(float* values, Vector vector) { _mm_storeu_ps(values, vector); }
+        static Vector Splat(float value) { return _mm_set1_ps(value); }
+        static Mask Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+        static Mask NotFinite(Vector a) { return _mm_cmpnle_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), a), _mm_set1_ps(numeric_limits<float>::max())); }
+        static Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return _mm_max_ps(low, _mm_min_ps(high, a)); }
+        static bool Any(Mask mask) { return _mm_movemask_ps(mask) != 0; }
+    };
+
+    template<>
+    struct SimdOps<double>
+    {
+        using Vector = __m128d;
+        using Mask = __m128d;
+        static constexpr size_t Width = 2;
+        static Vector Load(const double* values) { return _mm_loadu_pd(values); }
+        static void Store(double* values, Vector vector) { _mm_storeu_pd(values, vector); }
+        static Vector Splat(double value) { return _mm_set1_pd(value); }
+        static Mask Less(Vector a, Vector b) { return _mm_cmplt_pd(a, b); }
+        static Mask NotFinite(Vector a) { return _mm_cmpnle_pd(_mm_andnot_pd(_mm_set1_pd(-0.0), a), _mm_set1_pd(numeric_limits<double>::max())); }
+        static Mask Or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return _mm_max_pd(low, _mm_min_pd(high, a)); }
+        static bool Any(Mask mask) { return _mm_movemask_pd(mask) != 0; }
+    };
+#elif defined(PROPERTY_SIMD_NEON)
+    template<>
+    struct SimdOps<float>
+    {
+        using Vector = float32x4_t;
+        using Mask = uint32x4_t;
+        static constexpr size_t Width = 4;
+        static Vector Load(const float* values) { return vld1q_f32(values); }
+        static void Store(float* values, Vector vector) { vst1q_f32(values, vector); }
+        static Vector Splat(float value) { return vdupq_n_f32(value); }
+        static Mask Less(Vector a, Vector b) { return vcltq_f32(a, b); }
+        static Mask NotFinite(Vector a) { return vmvnq_u32(vcleq_f32(vabsq_f32(a), vdupq_n_f32(numeric_limits<float>::max()))); }
+        static Mask Or(Mask a, Mask b) { return vorrq_u32(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return vbslq_f32(vcltq_f32(a, low), low, vbslq_f32(vcltq_f32(high, a), high, a)); }
+        static bool Any(Mask mask) { return vmaxvq_u32(mask) != 0; }
+    };
+
+    template<>
+    struct SimdOps<double>
+    {
+        using Vector = float64x2_t;
+        using Mask = uint64x2_t;
+        static constexpr size_t Width = 2;
+        static Vector Load(const double* values) { return vld1q_f64(values); }
+        static void Store(double* values, Vector vector) { vst1q_f64(values, vector); }
+        static Vector Splat(double value) { return vdupq_n_f64(value); }
+        static Mask Less(Vector a, Vector b) { return vcltq_f64(a, b); }
+        static Mask NotFinite(Vector a) { return vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(vcleq_f64(vabsq_f64(a), vdupq_n_f64(numeric_limits<double>::max()))))); }
+        static Mask Or(Mask a, Mask b) { return vorrq_u64(a, b); }
+        static Vector Clamp(Vector a, Vector low, Vector high) { return vbslq_f64(vcltq_f64(a, low), low, vbslq_f64(vcltq_f64(high, a), high, a)); }
+        static bool Any(Mask mask) { return vmaxvq_u32(vreinterpretq_u32_u64(mask)) != 0; }
+    };
+#endif
+
+    /**
+     * @brief Clamp every value of a span into the closed range [low, high].
+     *
+     * Same result as clamping each value on its own; NaN is left untouched.
+     *
+     * @param values The values to clamp.
+     * @param count The number of values.
+     * @param low The lower bound.
+     * @param high The upper bound.
+     */
+    template<typename T>
+    void ClampSpan(T* values, size_t count, T low, T high)
+    {
+        size_t i = 0;
+        if constexpr (SimdOps<T>::Width > 0)
+        {
+            using Ops = SimdOps<T>;
+            const auto lows = Ops::Splat(low), highs = Ops::Splat(high);
+            for (; i + Ops::Width <= count; i += Ops::Width)
+            {
+                Ops::Store(values + i, Ops::Clamp(Ops::Load(values + i), lows, highs));
+            }
+        }
+        for (; i < count; ++i)
+        {
+            if (values[i] < low)
+                values[i] = low;
+            else if (high < values[i])
+                values[i] = high;
+        }
+    }
+
+    /**
+     * @brief Find the first value of a span outside the closed range [low, high].
+     *
+     * NaN counts as in range, like in the scalar comparison.
+     *
+     * @param values The values to check.
+     * @param count The number of values.
+     * @param low The lower bound.
+     * @param high The upper bound.
+     * @return The index of the first value out of range, or `count` if there is none.
+     */
+    template<typename T>
+    size_t FindOutOfRange(const T* values, size_t count, T low, T high)
+    {
+        size_t i = 0;
+        if constexpr (SimdOps<T>::Width > 0)
+        {
+            using Ops = SimdOps<T>;
+            const auto lows = Ops::Splat(low), highs = Ops::Splat(high);
+            for (; i + Ops::Width <= count; i += Ops::Width)
+            {
+                const auto value = Ops::Load(values + i);
+                if (Ops::Any(Ops::Or(Ops::Less(value, lows), Ops::Less(highs, value))))
+                    break; // The scalar loop finds which one.
+            }
+        }
+        for (; i < count; ++i)
+            if (values[i] < low || high < values[i])
+                return i;
+        return count;
+    }
+
+    /**
+     * @brief Find the first NaN or infinite value of a span.
+     * @param values The values to check.
+     * @param count The number of values.
+     * @return The index of the first value that is not finite, or `count` if there is none.
+     */
+    template<typename T>
+    size_t FindNotFinite(const T* values, size_t count)
+    {
+        if constexpr (!is_floating_point_v<T>)
+        {
+            return count;
+        }
+        else
+        {
+            size_t i = 0;
+            if constexpr (SimdOps<T>::Width > 0)
+            {
+                using Ops = SimdOps<T>;
+                for (; i + Ops::Width <= count; i += Ops::Width)
+                    if (Ops::Any(Ops::NotFinite(Ops::Load(values + i))))
+                        break; // The scalar loop finds which one.
+            }
+            for (; i < count; ++i)
+                if (!isfinite(values[i]))
+                    return i;
+            return count;
+        }
+    }
+}
@@ -0,0 +1,478 @@
+/*
+  MIT License
+  
+  Copyright (c) 2024 Mubarrat
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "property.h"
+
+using namespace std;
+
+/**
+ * @brief Hashed timer wheel running delayed tasks on one shared thread.
+ *
+ * Time is cut into ticks and every timer goes into the slot of the tick it is
+ * due in, so scheduling is constant time and any number of timers share the
+ * one thread. The thread sleeps while no timer is pending and wakes once per
+ * tick otherwise. Deadlines are rounded up to the next tick, and tasks never
+ * run early. Tasks run on the wheel thread in tick order and must not throw;
+ * a slow task delays the timers behind it.
+ */
+struct PropertyTimerWheel
+{
+    /**
+     * @brief Type definition for the clock deadlines refer to.
+     */
+    using Clock = chrono::steady_clock;
+
+    /**
+     * @brief Type definition for a scheduled task.
+     */
+    using Task = function<void()>;
+
+    /**
+     * @brief Start the wheel thread.
+     * @param tick The resolution of the wheel, at least one microsecond.
+     * @param slotCount The number of slots; timers further ahead wait for the wheel to come round.
+     */
+    explicit PropertyTimerWheel(chrono::nanoseconds tick = chrono::milliseconds(1), size_t slotCount = 512)
+        : m_tick(max<chrono::nanoseconds>(tick, chrono::microseconds(1))), m_slots(max<size_t>(slotCount, 1)),
+          m_origin(Clock::now()), m_thread([this] { Run(); }) {}
+
+    PropertyTimerWheel(const PropertyTimerWheel&) = delete;
+    PropertyTimerWheel& operator=(const PropertyTimerWheel&) = delete;
+
+    /**
+     * @brief Stop the wheel thread. Pending tasks are discarded without running.
+     */
+    ~PropertyTimerWheel()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+    }
+
+    /**
+     * @brief Get the wheel shared by rate-limited subscriptions that name none.
+     */
+    static PropertyTimerWheel& Default()
+    {
+        static PropertyTimerWheel wheel;
+        return wheel;
+    }
+
+    /**
+     * @brief Run a task on the wheel thread once a deadline has passed.
+     * @param deadline The earliest time to run the task.
+     * @param task The task to run.
+     */
+    void Schedule(Clock::time_point deadline, Task task)
+    {
+        bool wake;
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            uint64_t tick = max(TickAt(deadline), m_current + 1); // The current tick has already been processed.
+            m_slots[tick % m_slots.size()].push_back({ tick, std::move(task) });
+            wake = m_pending++ == 0; // The thread only sleeps until the next tick while timers are pending.
+        }
+        if (wake)
+            m_condition.notify_one();
+    }
+
+    /**
+     * @brief Get the resolution of the wheel.
+     */
+    chrono::nanoseconds Tick() const
+    {
+        return m_tick;
+    }
+
+    /**
+     * @brief Get the number of tasks waiting to run.
+     */
+    size_t Pending() const
+    {
+        lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+        return m_pending;
+    }
+
+private:
+    struct Timer
+    {
+        uint64_t tick; /// The tick the timer is due in.
+        Task task; /// The task to run.
+    };
+
+    /**
+     * @brief Get the first tick ending at or after a time point.
+     */
+    uint64_t TickAt(Clock::time_point time) const
+    {
+        if (time <= m_origin)
+            return 0;
+        return static_cast<uint64_t>((time - m_origin + m_tick - chrono::nanoseconds(1)) / m_tick);
+    }
+
+    void Run()
+    {
+        vector<Timer> due;
+        unique_lock<mutex> lock(m_mutex); // Ensure thread-safety.
+        while (!m_stopping)
+        {
+            if (m_pending == 0)
+            {
+                m_condition.wait(lock, [this] { return m_stopping || m_pending != 0; });
+                continue; // The first pass after idling visits every slot once.
+            }
+            m_condition.wait_until(lock, m_origin + m_tick * (m_current + 1), [this] { return m_stopping; });
+            if (m_stopping)
+                break;
+            uint64_t now = static_cast<uint64_t>((Clock::now() - m_origin) / m_tick); // The last tick that has ended.
+            if (now <= m_current)
+                continue;
+            uint64_t span = min<uint64_t>(now - m_current, m_slots.size()); // A full turn visits every slot.
+            for (uint64_t tick = m_current + 1; tick <= m_current + span; ++tick)
+            {
+                vector<Timer>& slot = m_slots[tick % m_slots.size()];
+                for (size_t i = 0; i < slot.size();)
+                {
+                    if (slot[i].tick <= now)
+                    {
+                        due.push_back(std::move(slot[i]));
+                        slot[i] = std::move(slot.back());
+                        slot.pop_back();
+                    }
+                    else
+                        ++i; // Due on a later turn of the wheel.
+                }
+            }
+            m_current = now;
+            if (due.empty())
+                continue;
+            m_pending -= due.size();
+            sort(due.begin(), due.end(), [](const Timer& a, const Timer& b) { return a.tick < b.tick; });
+            lock.unlock();
+            for (Timer& timer : due)
+                timer.task();
+            due.clear(); // Release the tasks before taking the lock again.
+            lock.lock();
+        }
+    }
+
+    const chrono::nanoseconds m_tick; /// The resolution of the wheel.
+    vector<vector<Timer>> m_slots; /// Timers by tick modulo the slot count.
+    const Clock::time_point m_origin; /// The start of tick zero.
+    uint64_t m_current = 0; /// The last tick processed.
+    size_t m_pending = 0; /// The number of timers in the slots.
+    bool m_stopping = false; /// Set when the wheel is being destroyed.
+    mutable mutex m_mutex; /// Mutex for thread-safe access.
+    condition_variable m_condition; /// Signaled when the first timer is scheduled or the wheel stops.
+    thread m_thread; /// The wheel thread, started last.
+};
+
+/**
+ * @brief How a rate-limited subscription spaces out its calls.
+ */
+enum class RateLimit
+{
+    Throttle, /// Call at once, then at most once per interval with the latest change.
+    Debounce, /// Call once no change has happened for an interval.
+    Sample, /// Call on a fixed period with the latest change, if there was one.
+};
+
+namespace PropertyInternals
+{
+    /**
+     * @brief Type-erased part of a rate limiter, cancelled by its subscription.
+     */
+    struct RateLimiterBase
+    {
+        virtual ~RateLimiterBase() = default;
+        virtual void Cancel() = 0;
+    };
+
+    /**
+     * @brief Coalesces the changes of a property and calls a callback from the timer wheel.
+     *
+     * Changes only copy the values under the limiter's mutex; the first old
+     * value and the latest new value of a burst are kept, so one call sums up
+     * every change since the previous call, and the wheel holds at most one
+     * timer per limiter.
+     */
+    template<typename T, typename Callback>
+    struct RateLimiter : RateLimiterBase, enable_shared_from_this<RateLimiter<T, Callback>>
+    {
+        using Clock = PropertyTimerWheel::Clock;
+
+        RateLimiter(RateLimit mode, chrono::nanoseconds interval, Callback callback, shared_ptr<PropertyDispatcher> dispatcher, PropertyTimerWheel& wheel)
+            : m_mode(mode), m_interval(max(interval, chrono::nanoseconds(0))), m_callback(std::move(callback)),
+              m_dispatcher(std::move(dispatcher)), m_wheel(wheel), m_start(Clock::now()), m_lastCall(m_start - m_interval) {}
+
+        /**
+         * @brief Record a change and arm the timer if it is not armed yet.
+         */
+        void OnChange(const T& oldValue, const T& newValue)
+        {
+            lock_guard<mutex> lock(m_mutex); // Ensure thread-safety.
+            if (!m_active)
+                return;
+            if (!m_newValue)
+                m_oldValue = oldValue; // First change of the burst.
+            m_newValue = newValue;
+            Clock::time_point now = Clock::now();
+            if (m_mode == RateLimit::Debounce)
+                m_quietUntil = now + m_interval;
+            if (m_armed)
+                return;
+            switch (m_mode)
+            {
+            case RateLimit::Throttle:
+                Arm(max(now, m_lastCall + m_interval));
+                break;
+            case RateLimit::Debounce:
+                Arm(m_quietUntil);
+                break;
+            case RateLimit::Sample:
+                Arm(NextSample(now));
+                break;
+            }
+        }
+
+        void Cancel() override
+        {
+            Callback callback;
+            unique_lock<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_active = false;
+            m_oldValue.reset();
+            m_newValue.reset();
+            bool inside = t_delivering == this; // Cancelled from its own callback, which cannot be waited for.
+            m_idle.wait(lock, [&] { return m_delivering == (inside ? 1u : 0u); });
+            if (!inside)
+                callback = std::move(m_callback); // Drop captured state now, outside the lock.
+        }
+
+    private:
+        void Arm(Clock::time_point deadline)
+        {
+            m_armed = true;
+            m_wheel.Schedule(deadline, [self = this->shared_from_this()] { self->OnTimer(); });
+        }
+
+        Clock::time_point NextSample(Clock::time_point now) const
+        {
+            if (m_interval.count() == 0)
+                return now;
+            return m_start + m_interval * ((now - m_start) / m_interval + 1);
+        }
+
+        void OnTimer()
+        {
+            unique_lock<mutex> lock(m_mutex); // Ensure thread-safety.
+            m_armed = false;
+            if (!m_active || !m_newValue)
+                return;
+            Clock::time_point now = Clock::now();
+            if (m_mode == RateLimit::Debounce && now < m_quietUntil)
+            {
+                Arm(m_quietUntil); // Changed again since the timer was armed.
+                return;
+            }
+            T oldValue = std::move(*m_oldValue), newValue = std::move(*m_newValue);
+            m_oldValue.reset();
+            m_newValue.reset();
+            m_lastCall = now;
+            if (m_dispatcher)
+            {
+                lock.unlock();
+                m_dispatcher->Post([self = this->shared_from_this(), oldValue = std::move(oldValue), newValue = std::move(newValue)]() mutable
+                {
+                    unique_lock<mutex> lock(self->m_mutex); // Ensure thread-safety.
+                    self->Invoke(lock, oldValue, newValue);
+                });
+            }
+            else
+                Invoke(lock, oldValue, newValue);
+        }
+
+        void Invoke(unique_lock<mutex>& lock, T& oldValue, T& newValue)
+        {
+            if (!m_active)
+                return;
+            ++m_delivering;
+            lock.unlock();
+            const void* outer = t_delivering;
+            t_delivering = this;
+            m_callback(oldValue, newValue);
+            t_delivering = outer;
+            lock.lock();
+            --m_delivering;
+            m_idle.notify_all();
+        }
+
+        static thread_local inline const void* t_delivering = nullptr; /// The limiter whose callback the thread is running.
+
+        const RateLimit m_mode; /// How calls are spaced out.
+        const chrono::nanoseconds m_interval; /// The throttle interval, quiet period or sampling period.
+        Callback m_callback; /// The callback of the subscriber.
+        const shared_ptr<PropertyDispatcher> m_dispatcher; /// Where calls are posted, or null to run them on the wheel thread.
+        PropertyTimerWheel& m_wheel; /// The wheel timers are scheduled on.
+        const Clock::time_point m_start; /// The phase of the sampling period.
+        Clock::time_point m_lastCall; /// When the callback was last called, for throttling.
+        Clock::time_point m_quietUntil; /// When the debounce quiet period ends.
+        optional<T> m_oldValue; /// The value before the first change not delivered yet.
+        optional<T> m_newValue; /// The latest value not delivered yet, empty if there is none.
+        size_t m_delivering = 0; /// The number of calls in progress.
+        bool m_armed = false; /// Whether a timer is scheduled.
+        bool m_active = true; /// Cleared by Cancel.
+        mutex m_mutex; /// Mutex for thread-safe access.
+        condition_variable m_idle; /// Signaled when a call returns.
+    };
+}
+
+/**
+ * @brief Token owning a rate-limited change callback, returned by `SubscribeThrottled` and friends.
+ *
+ * Destroying or resetting the token removes the callback from the property,
+ * discards the change waiting for a timer and waits for a call in progress to
+ * return, unless it is reset from that call. A call already posted to a
+ * dispatcher is skipped.
+ */
+struct TimedSubscription
+{
+    TimedSubscription() = default;
+
+    /**
+     * @brief Constructor.
+     * @param subscription The registration of the limiter with the property.
+     * @param limiter The limiter.
+     */
+    TimedSubscription(Subscription subscription, shared_ptr<PropertyInternals::RateLimiterBase> limiter)
+        : m_subscription(std::move(subscription)), m_limiter(std::move(limiter)) {}
+
+    TimedSubscription(TimedSubscription&&) noexcept = default;
+
+    TimedSubscription& operator=(TimedSubscription&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_subscription = std::move(other.m_subscription);
+            m_limiter = std::move(other.m_limiter);
+        }
+        return *this;
+    }
+
+    ~TimedSubscription()
+    {
+        Reset();
+    }
+
+    /**
+     * @brief Stop calling the callback and empty the token.
+     */
+    void Reset()
+    {
+        m_subscription.Reset();
+        if (shared_ptr<PropertyInternals::RateLimiterBase> limiter = std::move(m_limiter))
+            limiter->Cancel();
+    }
+
+    /**
+     * @brief Check whether the token holds a callback of a property that still exists.
+     */
+    explicit operator bool() const
+    {
+        return static_cast<bool>(m_subscription);
+    }
+
+private:
+    Subscription m_subscription; /// The registration with the property.
+    shared_ptr<PropertyInternals::RateLimiterBase> m_limiter; /// The limiter, shared with its pending timer.
+};
+
+/**
+ * @brief Register a change callback called through a rate limiter.
+ * @param property The property to observe.
+ * @param mode How calls are spaced out.
+ * @param interval The throttle interval, quiet period or sampling period.
+ * @param callback Called with the value before the first coalesced change and the latest value.
+ * @param dispatcher Where calls are posted, or null to run them on the wheel thread.
+ * @param wheel The timer wheel to schedule on.
+ * @return The token owning the registration.
+ */
+template<typename T, typename Policy>
+[[nodiscard]] TimedSubscription SubscribeRateLimited(Property<T, Policy>& property, RateLimit mode, chrono::nanoseconds interval,
+    typename Property<T, Policy>::ChangeCallback callback, shared_ptr<PropertyDispatcher> dispatcher = nullptr,
+    PropertyTimerWheel& wheel = PropertyTimerWheel::Default())
+{
+    using Limiter = PropertyInternals::RateLimiter<T, typename Property<T, Policy>::ChangeCallback>;
+    auto limiter = make_shared<Limiter>(mode, interval, std::move(callback), std::move(dispatcher), wheel);
+    Subscription subscription = property.Subscribe([limiter](T& oldValue, T& newValue) { limiter->OnChange(oldValue, newValue); });
+    return TimedSubscription(std::move(subscription), std::move(limiter));
+}
+
+/**
+ * @brief Register a change callback called at once, then at most once per interval.
+ *
+ * Changes within the interval after a call are coalesced into one trailing call when it ends.
+ */
+template<typename T, typename Policy>
+[[nodiscard]] TimedSubscription SubscribeThrottled(Property<T, Policy>& property, chrono::nanoseconds interval,
+    typename Property<T, Policy>::ChangeCallback callback, shared_ptr<PropertyDispatcher> dispatcher = nullptr,
+    PropertyTimerWheel& wheel = PropertyTimerWheel::Default())
+{
+    return SubscribeRateLimited(property, RateLimit::Throttle, interval, std::move(callback), std::move(dispatcher), wheel);
+}
+
+/**
+ * @brief Register a change callback called once the property has not changed for a quiet period.
+ */
+template<typename T, typename Policy>
+[[nodiscard]] TimedSubscription SubscribeDebounced(Property<T, Policy>& property, chrono::nanoseconds quietPeriod,
+    typename Property<T, Policy>::ChangeCallback callback, shared_ptr<PropertyDispatcher> dispatcher = nullptr,
+    PropertyTimerWheel& wheel = PropertyTimerWheel::Default())
+{
+    return SubscribeRateLimited(property, RateLimit::Debounce, quietPeriod, std::move(callback), std::move(dispatcher), wheel);
+}
+
+/**
+ * @brief Register a change callback called on a fixed period with the latest change, skipping periods without one.
+ */
+template<typename T, typename Policy>
+[[nodiscard]] TimedSubscription SubscribeSampled(Property<T, Policy>& property, chrono::nanoseconds period,
+    typename Property<T, Policy>::ChangeCallback callback, shared_ptr<PropertyDispatcher> dispatcher = nullptr,
+    PropertyTimerWheel& wheel = PropertyTimerWheel::Default())
+{
+    return SubscribeRateLimited(property, RateLimit::Sample, period, std::move(callback), std::move(dispatcher), wheel);
+}